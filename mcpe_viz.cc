@@ -87,8 +87,7 @@
   -- a btn for mcpe_viz --help output (to see usage)
   -- a text field for "Add Params"
 
-  * minimize geojson output?
-  -- remove spaces
+  * minimize geojson output? (--geojson-compact removes spaces; .geojson.bin interns the property values)
   -- simplify the properties? e.g. GType=Foo where Foo is the type of this record
 
   * auto-tile (and useTilesFlag) should be per-dimension
@@ -210,8 +209,20 @@
 #include <getopt.h>
 #include <math.h>
 #include <dirent.h>
+#include <zlib.h>
 
 #include <random>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <tuple>
+#include <atomic>
+#include <array>
+#include <unordered_map>
+#include <chrono>
+#include <sstream>
 
 #include "leveldb/db.h"
 #include "leveldb/env.h"
@@ -249,9 +260,12 @@ namespace mcpe_viz {
   // todobig -- would be nice for these to be in world class
   double playerPositionImageX=0.0, playerPositionImageY=0.0;
   int32_t playerPositionDimensionId=kDimIdOverworld;
+  double playerPositionWorldX=0.0, playerPositionWorldZ=0.0;
+
+  bool deferImageCoordsFlag = false;
   
   // list of geojson items
-  std::vector<std::string> listGeoJSON;
+  GeoJsonSink geojsonSink;
   
   // palettes
   int32_t palRedBlackGreen[256];
@@ -318,8 +332,12 @@ namespace mcpe_viz {
     std::string fnXml;
     std::string fnLog;
     std::string fnGeoJSON;
+    std::string fnGeoJSONBin;
+    std::string fnGeoJSONGz;
     std::string fnHtml;
     std::string fnJs;
+    std::string fnChunkCache;
+
       
     // per-dimension filenames
     std::string fnLayerTop[kDimIdCount];
@@ -353,8 +371,15 @@ namespace mcpe_viz {
     bool noForceGeoJSONFlag;
     bool shortRunFlag;
     bool colorTestFlag;
+    bool benchUnameFlag;
+    bool benchFormatFlag;
     bool verboseFlag;
     bool quietFlag;
+    bool singlePassFlag;
+    bool chunkCacheFlag;
+    bool topOnlyFlag;
+    bool geojsonCompactFlag;
+    bool directTilesFlag;
     int32_t movieX, movieY, movieW, movieH;
 
     bool doFindImages;
@@ -374,6 +399,9 @@ namespace mcpe_viz {
     // this is the block_size used by leveldb
     int32_t leveldbBlockSize = 4096;
 
+    // number of threads used to decode chunks in dbParse (1 == no worker threads)
+    int32_t threadCount;
+
     Control() {
       init();
     }
@@ -391,8 +419,11 @@ namespace mcpe_viz {
       fnOutputBase = "";
       fnLog = "";
       fnGeoJSON = "";
+      fnGeoJSONBin = "";
+      fnGeoJSONGz = "";
       fnHtml = "";
       fnJs = "";
+      fnChunkCache = "";
       doDetailParseFlag = false;
 
       doMovie = kDoOutputNone;
@@ -422,8 +453,15 @@ namespace mcpe_viz {
       
       shortRunFlag = false;
       colorTestFlag = false;
+      benchUnameFlag = false;
+      benchFormatFlag = false;
       verboseFlag = false;
       quietFlag = false;
+      singlePassFlag = false;
+      chunkCacheFlag = false;
+      topOnlyFlag = false;
+      geojsonCompactFlag = false;
+      directTilesFlag = false;
       movieX = movieY = movieW = movieH = 0;
       fpLogNeedCloseFlag = false;
       fpLog = stdout;
@@ -431,6 +469,8 @@ namespace mcpe_viz {
       leveldbFilter = 10;
       leveldbBlockSize = 4096;
 
+      threadCount = 1;
+
       // todo - cmdline option for this?
       heightMode = kHeightModeTop;
 
@@ -451,7 +491,17 @@ namespace mcpe_viz {
       }
     }
 
-    void setupOutput() {
+    // --direct-tiles: tiles are written as the images are made (instead of being cut from the full-size images)
+    bool useDirectTiles() const {
+      return directTilesFlag && doTiles && doHtml;
+    }
+
+    // features are split into tiles when the web app loads them by url (they can't be fetched from file:// pages)
+    bool useFeatureTiles() const {
+      return doTiles && doHtml && noForceGeoJSONFlag;
+    }
+
+    int32_t setupOutput() {
       if ( fnLog.compare("-") == 0 ) {
         fpLog = stdout;
         fpLogNeedCloseFlag = false;
@@ -474,14 +524,33 @@ namespace mcpe_viz {
       logger.setStdout(fpLog);
       logger.setStderr(stderr);
 
+      if ( chunkCacheFlag ) {
+        fnChunkCache = fnOutputBase + ".chunkcache";
+      }
+
       if ( doHtml ) {
         fnGeoJSON = fnOutputBase + ".geojson";
+        // note: the web app can only fetch the binary feature file when it is not loading geojson via a script tag
+        if ( noForceGeoJSONFlag ) {
+          fnGeoJSONBin = fnOutputBase + ".geojson.bin";
+        }
+        if ( geojsonCompactFlag ) {
+          fnGeoJSONGz = fnOutputBase + ".geojson.gz";
+        }
           
-        listGeoJSON.clear();
+        std::string fnSpool = fnOutputBase + ".geojson.spool";
+        if ( geojsonSink.open(fnSpool) != 0 ) {
+          slogger.msg(kLogInfo1,"ERROR: Failed to create temp file for geojson (%s error=%s (%d)).\n", fnSpool.c_str(), strerror(errno), errno);
+          return -1;
+        }
+        if ( geojsonSink.isTempFile() ) {
+          slogger.msg(kLogInfo1,"WARNING: Failed to create %s -- using a system temp file for geojson\n", fnSpool.c_str());
+        }
 
         fnHtml = fnOutputBase + ".html";
         fnJs = fnOutputBase + ".js";
       }
+      return 0;
     }
       
   };
@@ -739,17 +808,51 @@ namespace mcpe_viz {
   }
 
 
-  inline uint8_t getBlockId_LevelDB_v7(const char* p, int blocksPerWord, int bitsPerBlock, int32_t x, int32_t z, int32_t y) {
-    //int bitstart = ( (((x*16) + z) * 16) + y ) * bitsPerBlock;
-    // int bitstart = ( (((y*16) + x) * 16) + z ) * bitsPerBlock;
+  // position of a block in an unpacked v7 sub-chunk
+  inline int32_t _calcOffsetBlock_LevelDB_v7(int32_t x, int32_t z, int32_t y) {
+    return (((x*16) + z) * 16) + y;
+  }
+  
+  // unpack all of the palette indices in a v7 sub-chunk at once
+  // blocks are packed low bits first into 4-byte words and do not span words, so we load each word once
+  // note: same as myParseInt32 et al -- we assume a little-endian host
+  template <int32_t bitsPerBlock>
+  inline void _unpackBlockIds_LevelDB_v7(const char* p, uint16_t* out) {
+    const int32_t blocksPerWord = 32 / bitsPerBlock;
+    const uint32_t mask = (1u << bitsPerBlock) - 1;
+    const int32_t fullWordCt = 4096 / blocksPerWord;
+    int32_t blockPos = 0;
+    uint32_t word;
+    for (int32_t w=0; w < fullWordCt; w++) {
+      memcpy(&word, &p[w*4], 4);
+      for (int32_t i=0; i < blocksPerWord; i++) {
+        out[blockPos++] = (uint16_t)((word >> (i * bitsPerBlock)) & mask);
+      }
+    }
+    // the last word may be partly used
+    const int32_t tailCt = 4096 % blocksPerWord;
+    if ( tailCt > 0 ) {
+      memcpy(&word, &p[fullWordCt*4], 4);
+      for (int32_t i=0; i < tailCt; i++) {
+        out[blockPos++] = (uint16_t)((word >> (i * bitsPerBlock)) & mask);
+      }
+    }
+  }
 
-    int blockPos = (((x*16) + z) * 16) + y;
-    // we find which 4-byte word we want
-    int wordStart = blockPos / blocksPerWord;
-    // we find the bit offset within that 4-byte word
-    int bitOffset = (blockPos % blocksPerWord) * bitsPerBlock;
-    int bitStart = wordStart * 4 * 8 + bitOffset;
-    return getBitsFromBytes(p, bitStart, bitsPerBlock);
+  inline int32_t unpackBlockIds_LevelDB_v7(const char* p, int32_t bitsPerBlock, uint16_t* out) {
+    switch ( bitsPerBlock ) {
+    case 1: _unpackBlockIds_LevelDB_v7<1>(p, out); return 0;
+    case 2: _unpackBlockIds_LevelDB_v7<2>(p, out); return 0;
+    case 3: _unpackBlockIds_LevelDB_v7<3>(p, out); return 0;
+    case 4: _unpackBlockIds_LevelDB_v7<4>(p, out); return 0;
+    case 5: _unpackBlockIds_LevelDB_v7<5>(p, out); return 0;
+    case 6: _unpackBlockIds_LevelDB_v7<6>(p, out); return 0;
+    case 8: _unpackBlockIds_LevelDB_v7<8>(p, out); return 0;
+    case 16: _unpackBlockIds_LevelDB_v7<16>(p, out); return 0;
+    default:
+      break;
+    }
+    return -1;
   }
   
 
@@ -822,6 +925,200 @@ namespace mcpe_viz {
     return 0;
   }  
   
+  // a v7 chunk palette resolved to old-school block id's
+  // note: we keep the warnings from resolving it so that a cached palette logs exactly what a fresh one would
+  class ChunkPalette {
+  public:
+    std::string key;
+    std::vector<int32_t> blockId;
+    std::vector<int32_t> blockData;
+
+    enum NoteType : int32_t {
+      kNoteNotCompound = 0,
+      kNoteUnknownName = 1,
+      kNoteMissingTags = 2
+    };
+    struct Note {
+      NoteType type;
+      int32_t index;
+      std::string name;
+    };
+    std::vector<Note> noteList;
+
+    void addNote(NoteType type, int32_t index, const std::string& name) {
+      Note n;
+      n.type = type;
+      n.index = index;
+      n.name = name;
+      noteList.push_back(n);
+    }
+    
+    void logNotes() const {
+      for ( const auto& n : noteList ) {
+        switch ( n.type ) {
+        case kNoteNotCompound:
+          logger.msg(kLogWarning,"Unexpected NBT format in _do_chunk_v7\n");
+          break;
+        case kNoteUnknownName: {
+          // note: this is the warning that getBlockByUname puts
+          std::string uname = n.name;
+          std::transform(uname.begin(), uname.end(), uname.begin(), ::tolower);
+          slogger.msg(kLogWarning, "getBlockByUname failed to find uname=%s\n", uname.c_str());
+          logger.msg(kLogWarning,"Did not find block uname '%s' in XML file\n", n.name.c_str());
+          break;
+        }
+        case kNoteMissingTags:
+          slogger.msg(kLogError,"(Safe) Did not find 'name' and/or 'val' tags in a chunk palette! (i=%d) (len=%d)\n"
+                      , n.index, (int)blockId.size() );
+          break;
+        }
+      }
+    }
+  };
+
+  
+  // reads a v7 chunk palette -- we only want 'name' and 'val' from each compound, so we visit the nbt
+  // instead of building tags for it
+  class ChunkPaletteVisitor : public NbtVisitor {
+  private:
+    ChunkPalette& palette;
+    std::string bname;
+    int32_t bdata;
+    bool nameFlag, valFlag;
+
+  public:
+    ChunkPaletteVisitor(ChunkPalette& tpalette)
+      : palette(tpalette)
+    {
+      bdata = 0;
+      nameFlag = valFlag = false;
+    }
+
+    bool enterTag(const Path& path) {
+      if ( path.size() == 1 ) {
+        palette.blockId.push_back(0);
+        palette.blockData.push_back(0);
+        if ( path.back().type != nbt::tag_type::Compound ) {
+          palette.addNote(ChunkPalette::kNoteNotCompound, path.back().index, "");
+          return false;
+        }
+        nameFlag = valFlag = false;
+        return true;
+      }
+      // skip everything but the two tags we want
+      if ( path.size() == 2 ) {
+        return ( path.back().type == nbt::tag_type::String && keyIs(path, "name") ) ||
+          ( path.back().type == nbt::tag_type::Short && keyIs(path, "val") );
+      }
+      return false;
+    }
+
+    void onString(const Path& /*path*/, const char* s, int32_t len) {
+      bname.assign(s, len);
+      nameFlag = true;
+    }
+
+    void onInteger(const Path& /*path*/, int64_t v) {
+      bdata = (int32_t)v;
+      valFlag = true;
+    }
+
+    void leaveTag(const Path& path) {
+      if ( path.size() != 1 ) {
+        return;
+      }
+      size_t i = palette.blockId.size() - 1;
+      if ( nameFlag && valFlag ) {
+        int32_t blockId, blockData;
+        // note: the quiet version because the warning goes in the notes (see ChunkPalette::logNotes)
+        if ( getBlockByUname_quiet(bname, blockId, blockData) == 0 ) {
+          palette.blockId[i] = blockId;
+          // todonow - correct?
+          palette.blockData[i] = bdata;
+        } else {
+          palette.addNote(ChunkPalette::kNoteUnknownName, (int32_t)i, bname);
+          // todonow - reasonable?
+          palette.blockId[i] = 0;
+          palette.blockData[i] = 0;
+        }
+      } else {
+        palette.addNote(ChunkPalette::kNoteMissingTags, (int32_t)i, "");
+      }
+    }
+  };
+
+
+  // most sub-chunks share a handful of palettes (e.g. air+stone+dirt), so we resolve each distinct palette once
+  // note: this is shared by the decode threads
+  class ChunkPaletteCache {
+  private:
+    // todo - param?
+    static const size_t kMaxPalettes = 65536;
+    
+    std::mutex mtx;
+    std::unordered_map<uint64_t, std::shared_ptr<const ChunkPalette> > palettes;
+    std::atomic<int64_t> hitCt, missCt;
+
+  public:
+    ChunkPaletteCache() {
+      hitCt = 0;
+      missCt = 0;
+    }
+
+    std::shared_ptr<const ChunkPalette> get(const char* buf, int32_t bufLen, int32_t numToRead) {
+      // note: the key is only the palette tags -- not the block data or storages that follow them in the record
+      int32_t keyLen = measureNbt(buf, bufLen, numToRead);
+      uint64_t h = hashBytes(kHashBytesInit, (const char*)&numToRead, sizeof(numToRead));
+      h = hashBytes(h, buf, keyLen);
+
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = palettes.find(h);
+        if ( it != palettes.end() && it->second->key.size() == (size_t)keyLen &&
+             memcmp(it->second->key.data(), buf, keyLen) == 0 ) {
+          hitCt++;
+          return it->second;
+        }
+      }
+
+      // note: we resolve a miss without the lock so that threads do not wait on each other's misses
+      // (two threads may resolve the same palette at once -- the first one to get back keeps it)
+      missCt++;
+      std::shared_ptr<ChunkPalette> palette(new ChunkPalette());
+      ChunkPaletteVisitor visitor(*palette);
+      visitNbt(buf, keyLen, numToRead, visitor);
+      palette->key.assign(buf, keyLen);
+
+      std::lock_guard<std::mutex> lock(mtx);
+      auto it = palettes.find(h);
+      if ( it == palettes.end() ) {
+        if ( palettes.size() < kMaxPalettes ) {
+          palettes[h] = palette;
+        }
+      } else if ( it->second->key == palette->key ) {
+        return it->second;
+      }
+      return palette;
+    }
+
+    void getStats(int64_t& thitCt, int64_t& tmissCt, int64_t& paletteCt) {
+      std::lock_guard<std::mutex> lock(mtx);
+      thitCt = hitCt;
+      tmissCt = missCt;
+      paletteCt = palettes.size();
+    }
+  };
+
+  ChunkPaletteCache chunkPaletteCache;
+
+  
+  std::shared_ptr<const ChunkPalette> readChunkPalette_v7(const char* buf, int32_t bufLen, int32_t numToRead) {
+    std::shared_ptr<const ChunkPalette> palette = chunkPaletteCache.get(buf, bufLen, numToRead);
+    palette->logNotes();
+    return palette;
+  }
+
+  
   int32_t convertChunkV7toV3(const char* cdata, size_t cdata_size, int16_t* emuchunk) {
     // we have a v7 chunk and we want to unpack it into a v3-like chunk
     // determine location of chunk palette
@@ -841,66 +1138,33 @@ namespace mcpe_viz {
     }
 
     // read chunk palette and associate old-school block id's
-    MyNbtTagList tagList;
     int xoff = offsetBlockInfoList + 6 + extraOffset;
-    parseNbtQuiet(&cdata[xoff], cdata_size-xoff, cdata[offsetBlockInfoList + 3], tagList);
-    
-    std::vector<int32_t> chunkBlockPalette_BlockId(tagList.size());
-    std::vector<int32_t> chunkBlockPalette_BlockData(tagList.size());
+    std::shared_ptr<const ChunkPalette> palette = readChunkPalette_v7(&cdata[xoff], cdata_size-xoff, cdata[offsetBlockInfoList + 3]);
     
-    for ( size_t i=0; i < tagList.size(); i++ ) { 
-      // check tagList
-      if ( tagList[i].second->get_type() == nbt::tag_type::Compound ) {
-        nbt::tag_compound tc = tagList[i].second->as<nbt::tag_compound>();
-
-        bool processedFlag = false;
-        if ( tc.has_key("name", nbt::tag_type::String) ) {
-          std::string bname = tc["name"].as<nbt::tag_string>().get();
-          if ( tc.has_key("val", nbt::tag_type::Short) ) {
-            int bdata = tc["val"].as<nbt::tag_short>().get();
-            
-            int32_t blockId, blockData;
-            if ( getBlockByUname(bname, blockId, blockData) == 0 ) {
-              chunkBlockPalette_BlockId[i] = blockId;
-              // todonow - correct?
-              chunkBlockPalette_BlockData[i] = bdata;
-            } else {
-              logger.msg(kLogWarning,"Did not find block uname '%s' in XML file\n", bname.c_str());
-              // todonow - reasonable?
-              chunkBlockPalette_BlockId[i] = 0;
-              chunkBlockPalette_BlockData[i] = 0;
-            }
-            processedFlag = true;
-          }
-        }
-        if ( ! processedFlag ) {
-          slogger.msg(kLogError,"(Safe) Did not find 'name' and/or 'val' tags in a chunk palette! (i=%d) (len=%d)\n"
-                      , (int)i, (int)tagList.size() );
-          //todozooz - dump tc to screen log
-        }
-      } else {
-        logger.msg(kLogWarning,"Unexpected NBT format in _do_chunk_v7\n");
-      }
+    //todozooz -- new 16-bit block-id's (instead of 8-bit) are a BIG issue - this needs attention here
+    uint16_t paletteBlockIds[16*16*16];
+    if ( unpackBlockIds_LevelDB_v7(&cdata[2 + extraOffset], bitsPerBlock, paletteBlockIds) != 0 ) {
+      return -1;
     }
     
-    //todozooz -- new 16-bit block-id's (instead of 8-bit) are a BIG issue - this needs attention here
     // iterate over chunk space
-    uint8_t paletteBlockId, blockData;
+    uint16_t paletteBlockId;
+    uint8_t blockData;
     int32_t blockId;
     for (int32_t cy=0; cy < 16; cy++) {
       for ( int32_t cx=0; cx < 16; cx++) {
         for ( int32_t cz=0; cz < 16; cz++ ) {
-          paletteBlockId = getBlockId_LevelDB_v7(&cdata[2 + extraOffset], blocksPerWord, bitsPerBlock, cx,cz,cy);
+          paletteBlockId = paletteBlockIds[_calcOffsetBlock_LevelDB_v7(cx,cz,cy)];
           
           // look up blockId
           //todonow error checking
-          if ( paletteBlockId < chunkBlockPalette_BlockId.size() ) {
-            blockId = chunkBlockPalette_BlockId[paletteBlockId];
-            blockData = chunkBlockPalette_BlockData[paletteBlockId];
+          if ( paletteBlockId < palette->blockId.size() ) {
+            blockId = palette->blockId[paletteBlockId];
+            blockData = palette->blockData[paletteBlockId];
           } else {
             blockId = 0;
             blockData = 0;
-            logger.msg(kLogWarning,"Found chunk palette id out of range %d (size=%d)\n", paletteBlockId, (int)chunkBlockPalette_BlockId.size());
+            logger.msg(kLogWarning,"Found chunk palette id out of range %d (size=%d)\n", paletteBlockId, (int)palette->blockId.size());
           }
 
           int32_t bdoff = _calcOffsetBlock_LevelDB_v3(cx,cz,cy);
@@ -958,10 +1222,64 @@ namespace mcpe_viz {
   }
 
 
-  int32_t findEntityByUname(const EntityInfoList &m, std::string& un) {
-    // convert search key to lower case
-    std::string uname = un;
-    std::transform(uname.begin(), uname.end(), uname.begin(), ::tolower);
+  // the uname lookups used to scan every block, item and entity -- these are built once after we read the xml
+  // note: the first match wins, as it did with the scans
+  class UnameIndex {
+  public:
+    bool builtFlag;
+    std::unordered_map<std::string, int32_t> blockIdMap;
+    std::unordered_map<std::string, std::pair<int32_t,int32_t> > blockVariantMap;
+    std::unordered_map<std::string, int32_t> itemIdMap;
+    std::unordered_map<std::string, int32_t> entityIdMap;
+
+    UnameIndex() {
+      builtFlag = false;
+    }
+    
+    void build() {
+      blockIdMap.clear();
+      blockVariantMap.clear();
+      itemIdMap.clear();
+      entityIdMap.clear();
+      
+      for (const auto& it : blockInfoList ) {
+        for ( const auto& u : it.unameList ) {
+          blockIdMap.insert(std::make_pair(u, it.id));
+          blockVariantMap.insert(std::make_pair(u, std::make_pair(it.id, 0)));
+        }
+        for (const auto& itbv : it.variantList) {
+          for ( const auto& u : itbv->unameList ) {
+            blockVariantMap.insert(std::make_pair(u, std::make_pair(it.id, itbv->blockdata)));
+          }
+        }
+      }
+      for (const auto& it : itemInfoList) {
+        for ( const auto& u : it.second->unameList ) {
+          itemIdMap.insert(std::make_pair(u, it.first));
+        }
+      }
+      for (const auto& it : entityInfoList) {
+        for ( const auto& u : it.second->unameList ) {
+          entityIdMap.insert(std::make_pair(u, it.first));
+        }
+      }
+      builtFlag = true;
+    }
+
+    static int32_t find(const std::unordered_map<std::string, int32_t>& m, const std::string& uname) {
+      auto it = m.find(uname);
+      return ( it != m.end() ) ? it->second : -1;
+    }
+  };
+
+  UnameIndex unameIndex;
+
+  void buildUnameIndex() {
+    unameIndex.build();
+  }
+
+
+  int32_t findEntityByUname_scan(const EntityInfoList &m, const std::string& uname) {
     for (const auto& it : m) {
       for ( const auto& u : it.second->unameList ) {
         if ( u == uname ) {
@@ -971,10 +1289,18 @@ namespace mcpe_viz {
     }
     return -1;
   }
-
-  int32_t findIdByItemName(std::string& un) {
+  
+  int32_t findEntityByUname(const EntityInfoList &m, std::string& un) {
+    // convert search key to lower case
     std::string uname = un;
     std::transform(uname.begin(), uname.end(), uname.begin(), ::tolower);
+    if ( unameIndex.builtFlag && (&m == &entityInfoList) ) {
+      return UnameIndex::find(unameIndex.entityIdMap, uname);
+    }
+    return findEntityByUname_scan(m, uname);
+  }
+
+  int32_t findIdByItemName_scan(const std::string& uname) {
     for (const auto& it : itemInfoList) {
       for ( const auto& u : it.second->unameList ) {
         if ( u == uname ) {
@@ -985,9 +1311,16 @@ namespace mcpe_viz {
     return -1;
   }
   
-  int32_t findIdByBlockName(std::string& un) {
+  int32_t findIdByItemName(std::string& un) {
     std::string uname = un;
     std::transform(uname.begin(), uname.end(), uname.begin(), ::tolower);
+    if ( unameIndex.builtFlag ) {
+      return UnameIndex::find(unameIndex.itemIdMap, uname);
+    }
+    return findIdByItemName_scan(uname);
+  }
+
+  int32_t findIdByBlockName_scan(const std::string& uname) {
     for (const auto& it : blockInfoList ) {
       for ( const auto& u : it.unameList ) {
         if ( u == uname ) {
@@ -997,6 +1330,15 @@ namespace mcpe_viz {
     }
     return -1;
   }
+  
+  int32_t findIdByBlockName(std::string& un) {
+    std::string uname = un;
+    std::transform(uname.begin(), uname.end(), uname.begin(), ::tolower);
+    if ( unameIndex.builtFlag ) {
+      return UnameIndex::find(unameIndex.blockIdMap, uname);
+    }
+    return findIdByBlockName_scan(uname);
+  }
 
   
   // todobig - it would be nice to do something like this, but unique_ptr stands in the way...
@@ -1023,16 +1365,13 @@ namespace mcpe_viz {
   }
 #endif
 
-  int32_t getBlockByUname(const std::string& un, int32_t& blockId, int32_t& blockData) {
-    // convert search key to lower case
-    std::string uname = un;
-    std::transform(uname.begin(), uname.end(), uname.begin(), ::tolower);
+  bool getBlockByUname_scan(const std::string& uname, int32_t& blockId, int32_t& blockData) {
     for (const auto& it : blockInfoList ) {
       for ( const auto& u : it.unameList ) {
         if ( u == uname ) {
           blockId = it.id;
           blockData = 0;
-          return 0;
+          return true;
         }
       }
       
@@ -1041,18 +1380,230 @@ namespace mcpe_viz {
           if ( u == uname ) {
             blockId = it.id;
             blockData = itbv->blockdata;
-            return 0;
+            return true;
           }
         }
       }
     }
+    return false;
+  }
+  
+  // same as getBlockByUname, but without the warning -- for callers that report misses themselves
+  int32_t getBlockByUname_quiet(const std::string& un, int32_t& blockId, int32_t& blockData) {
+    // convert search key to lower case
+    std::string uname = un;
+    std::transform(uname.begin(), uname.end(), uname.begin(), ::tolower);
+
+    if ( unameIndex.builtFlag ) {
+      auto it = unameIndex.blockVariantMap.find(uname);
+      if ( it != unameIndex.blockVariantMap.end() ) {
+        blockId = it->second.first;
+        blockData = it->second.second;
+        return 0;
+      }
+    } else {
+      if ( getBlockByUname_scan(uname, blockId, blockData) ) {
+        return 0;
+      }
+    }
 
     // force to "air"
     blockId = 0;
     blockData = 0;
+    return -1;
+  }
+
+  int32_t getBlockByUname(const std::string& un, int32_t& blockId, int32_t& blockData) {
+    if ( getBlockByUname_quiet(un, blockId, blockData) == 0 ) {
+      return 0;
+    }
+    std::string uname = un;
+    std::transform(uname.begin(), uname.end(), uname.begin(), ::tolower);
     slogger.msg(kLogWarning, "getBlockByUname failed to find uname=%s\n", uname.c_str());
     return -1;
   }
+
+
+  // compare the uname scans with the index -- this is just for testing
+  int32_t benchUnameLookup() {
+    std::vector<std::string> unameList;
+    for (const auto& it : blockInfoList ) {
+      for ( const auto& u : it.unameList ) {
+        unameList.push_back(u);
+      }
+      for (const auto& itbv : it.variantList) {
+        for ( const auto& u : itbv->unameList ) {
+          unameList.push_back(u);
+        }
+      }
+    }
+    for (const auto& it : itemInfoList) {
+      for ( const auto& u : it.second->unameList ) {
+        unameList.push_back(u);
+      }
+    }
+    for (const auto& it : entityInfoList) {
+      for ( const auto& u : it.second->unameList ) {
+        unameList.push_back(u);
+      }
+    }
+    // and some misses
+    unameList.push_back("minecraft:not_a_block");
+    unameList.push_back("not_an_entity");
+
+    // todo - param?
+    const int32_t rounds = 20;
+    int32_t blockId, blockData, mismatchCt = 0;
+    int64_t sum = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int32_t r=0; r < rounds; r++) {
+      for ( const auto& u : unameList ) {
+        if ( getBlockByUname_scan(u, blockId, blockData) ) {
+          sum += blockId + blockData;
+        }
+        sum += findIdByBlockName_scan(u) + findIdByItemName_scan(u) + findEntityByUname_scan(entityInfoList, u);
+      }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int32_t r=0; r < rounds; r++) {
+      for ( const auto& u : unameList ) {
+        auto it = unameIndex.blockVariantMap.find(u);
+        if ( it != unameIndex.blockVariantMap.end() ) {
+          sum -= it->second.first + it->second.second;
+        }
+        sum -= UnameIndex::find(unameIndex.blockIdMap, u) + UnameIndex::find(unameIndex.itemIdMap, u)
+          + UnameIndex::find(unameIndex.entityIdMap, u);
+      }
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    // check that the index gives the same answers as the scans
+    for ( const auto& u : unameList ) {
+      int32_t scanId = -1, scanData = -1;
+      getBlockByUname_scan(u, scanId, scanData);
+      auto it = unameIndex.blockVariantMap.find(u);
+      int32_t indexId = ( it != unameIndex.blockVariantMap.end() ) ? it->second.first : -1;
+      int32_t indexData = ( it != unameIndex.blockVariantMap.end() ) ? it->second.second : -1;
+      if ( scanId != indexId || scanData != indexData ||
+           findIdByBlockName_scan(u) != UnameIndex::find(unameIndex.blockIdMap, u) ||
+           findIdByItemName_scan(u) != UnameIndex::find(unameIndex.itemIdMap, u) ||
+           findEntityByUname_scan(entityInfoList, u) != UnameIndex::find(unameIndex.entityIdMap, u) ) {
+        slogger.msg(kLogInfo1,"ERROR: uname index mismatch for '%s'\n", u.c_str());
+        mismatchCt++;
+      }
+    }
+
+    // note: each name does four lookups (block+variant, block, item, entity)
+    double lookupCt = (double)rounds * (double)unameList.size() * 4.0;
+    double scanNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / lookupCt;
+    double indexNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / lookupCt;
+    slogger.msg(kLogInfo1,"Uname lookup: %d names, scan %.1f ns/lookup, index %.1f ns/lookup (%.1fx) (%d mismatches) (check=%lld)\n"
+                , (int)unameList.size(), scanNs, indexNs, (indexNs > 0.0) ? (scanNs / indexNs) : 0.0
+                , mismatchCt, (long long int)sum);
+    return mismatchCt;
+  }
+
+  // --bench-format: compare the geojson number formatting (appendFixed et al) with the sprintf/ostream path it replaced
+  int32_t benchNumberFormat() {
+    // todo - param?
+    const int32_t valueCt = 1000000;
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> coordDist(-30000.0, 30000.0);
+    std::uniform_int_distribution<int32_t> intDist(-30000, 30000);
+    std::vector<double> coordList;
+    std::vector<int32_t> intList;
+    for (int32_t i=0; i < valueCt; i++) {
+      // image coords are usually on a half pixel, entity positions are anywhere
+      double v = coordDist(rng);
+      coordList.push_back( (i & 1) ? v : (floor(v) + 0.5) );
+      intList.push_back(intDist(rng));
+    }
+
+    int64_t sizeOld = 0, sizeNew = 0;
+    int32_t mismatchCt = 0;
+    char tmpstring[256];
+    std::string s, snew;
+
+    // geojson coords -- "%.1lf,%.1lf"
+    auto t0 = std::chrono::steady_clock::now();
+    for (int32_t i=0; i+1 < valueCt; i+=2) {
+      s.clear();
+      sprintf(tmpstring,"%.1lf,%.1lf",coordList[i],coordList[i+1]);
+      s += tmpstring;
+      sizeOld += s.size();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int32_t i=0; i+1 < valueCt; i+=2) {
+      snew.clear();
+      appendFixed(snew, coordList[i], 1);
+      snew += ',';
+      appendFixed(snew, coordList[i+1], 1);
+      sizeNew += snew.size();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    // positions -- Point3d<T>::toGeoJSON used an ostream
+    for (int32_t i=0; i+2 < valueCt; i+=3) {
+      std::ostringstream str;
+      str << coordList[i] << "," << intList[i+1] << "," << coordList[i+2];
+      sizeOld += str.str().size();
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    for (int32_t i=0; i+2 < valueCt; i+=3) {
+      snew.clear();
+      appendNumber(snew, coordList[i]);
+      snew += ',';
+      appendNumber(snew, intList[i+1]);
+      snew += ',';
+      appendNumber(snew, coordList[i+2]);
+      sizeNew += snew.size();
+    }
+    auto t4 = std::chrono::steady_clock::now();
+
+    // check that we get the same output
+    for (int32_t i=0; i+2 < valueCt; i+=3) {
+      sprintf(tmpstring,"%.1lf,%.1lf",coordList[i],coordList[i+1]);
+      snew.clear();
+      appendFixed(snew, coordList[i], 1);
+      snew += ',';
+      appendFixed(snew, coordList[i+1], 1);
+      std::ostringstream str;
+      str << coordList[i] << "," << intList[i+1] << "," << coordList[i+2];
+      s.clear();
+      appendNumber(s, coordList[i]);
+      s += ',';
+      appendNumber(s, intList[i+1]);
+      s += ',';
+      appendNumber(s, coordList[i+2]);
+      if ( snew != tmpstring || s != str.str() ) {
+        if ( mismatchCt < 10 ) {
+          slogger.msg(kLogInfo1,"ERROR: number format mismatch: [%s] [%s] vs [%s] [%s]\n"
+                      , tmpstring, str.str().c_str(), snew.c_str(), s.c_str());
+        }
+        mismatchCt++;
+      }
+      sprintf(tmpstring, "%x", intList[i+1]);
+      snew.clear();
+      appendHex(snew, (uint32_t)intList[i+1]);
+      if ( snew != tmpstring ) {
+        if ( mismatchCt < 10 ) {
+          slogger.msg(kLogInfo1,"ERROR: hex format mismatch: [%s] vs [%s]\n", tmpstring, snew.c_str());
+        }
+        mismatchCt++;
+      }
+    }
+
+    double coordCt = (double)(valueCt / 2);
+    double posCt = (double)(valueCt / 3);
+    auto ns = [](std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b, double ct) {
+      return std::chrono::duration<double, std::nano>(b - a).count() / ct;
+    };
+    slogger.msg(kLogInfo1,"Number format: coords sprintf %.1f ns, append %.1f ns; pos ostream %.1f ns, append %.1f ns (%d mismatches) (check=%lld/%lld)\n"
+                , ns(t0, t1, coordCt), ns(t1, t2, coordCt), ns(t2, t3, posCt), ns(t3, t4, posCt)
+                , mismatchCt, (long long int)sizeOld, (long long int)sizeNew);
+    return mismatchCt;
+  }
   
   std::string getBlockName(int32_t id, int32_t blockdata) {
     if ( blockInfoList[id].isValid() ) {
@@ -1111,6 +1662,36 @@ namespace mcpe_viz {
   }
     
     
+  // geojson properties for a --geojson-block block
+  void appendGeojsonBlock(std::string& s, int32_t blockId, int32_t dimId, int32_t x, int32_t y, int32_t z) {
+    s += "\"Name\": \"";
+    s += blockInfoList[blockId].name;
+    s += "\", \"Block\": true, \"Dimension\": \"";
+    appendInt(s, dimId);
+    s += "\", \"Pos\": [";
+    appendInt(s, x);
+    s += ", ";
+    appendInt(s, y);
+    s += ", ";
+    appendInt(s, z);
+    s += "]} }";
+  }
+
+  // geojson properties for a --check-spawn block
+  void appendGeojsonSpawnable(std::string& s, int32_t lightLevel, int32_t dimId, int32_t x, int32_t y, int32_t z) {
+    s += "\"Spawnable\":true,\"Name\":\"Spawnable\",\"LightLevel\":\"";
+    appendInt(s, lightLevel);
+    s += "\",\"Dimension\":\"";
+    appendInt(s, dimId);
+    s += "\",\"Pos\":[";
+    appendInt(s, x);
+    s += ',';
+    appendInt(s, y);
+    s += ',';
+    appendInt(s, z);
+    s += "]}}";
+  }
+
   // todolib - better name for this
   class CheckSpawn {
   public:
@@ -1177,16 +1758,25 @@ namespace mcpe_viz {
 
   
   // todobig - perhaps this is silly (storing all this info per-chunk)
+  // note: we keep one of these for every chunk in the world, so we keep it small (see getMemoryUse) -- the top block id
+  //   and data share 16 bits, the grass color is only kept when we make the grass image, and the objects come from slabs
   class ChunkData_LevelDB : public ChunkData {
   public:
+    // the top block is packed as: block id (low 9 bits) | block data (high 7 bits)
+    static const int32_t kTopBlockIdBits = 9;
+    static const uint16_t kTopBlockIdMask = (1 << kTopBlockIdBits) - 1;
+    static const uint16_t kTopBlockDataMask = 0x7f;
+    
     // todobig - move to private?
     int32_t chunkX, chunkZ;
     //todozooz -- new 16-bit block-id's (instead of 8-bit) are a BIG issue - this needs attention here
-    uint16_t blocks[16][16];
-    uint8_t data[16][16];
-    uint32_t grassAndBiome[16][16];
+    uint16_t topBlock[16][16];
+    uint8_t biome[16][16];
+    // grass color (0xRRGGBB) as [cx * 16 + cz] -- nullptr when we do not make the grass image
+    std::unique_ptr<uint32_t[]> grass;
     uint8_t topBlockY[16][16];
     uint8_t heightCol[16][16];
+    // sky light (high nibble) | block light (low nibble)
     uint8_t topLight[16][16];
     bool checkSpawnFlag;
     int32_t chunkFormatVersion;
@@ -1194,19 +1784,106 @@ namespace mcpe_viz {
     // we parse the block (et al) data in a chunk from leveldb
     ChunkData_LevelDB() {
       // clear the data we track
-      memset(blocks, 0, sizeof(blocks));
+      memset(topBlock, 0, sizeof(topBlock));
       
       // todobig - clears are redundant?
-      memset(data, 0, sizeof(data));
-      //memset(grassAndBiome, 0, 16*16*sizeof(uint32_t));
+      memset(biome, 0, sizeof(biome));
       memset(topBlockY, 0, sizeof(topBlockY));
       //memset(heightCol,0, 16*16*sizeof(uint8_t));
       memset(topLight, 0, sizeof(topLight));
 
+      if ( control.doImageGrass != kDoOutputNone ) {
+        grass = std::unique_ptr<uint32_t[]>(new uint32_t[16 * 16]());
+        grassCount()++;
+      }
+      
       checkSpawnFlag = false;
       chunkFormatVersion = -1;
     }
 
+    ChunkData_LevelDB(const ChunkData_LevelDB&) = delete;
+    ChunkData_LevelDB& operator=(const ChunkData_LevelDB&) = delete;
+    
+    ~ChunkData_LevelDB() {
+      if ( grass ) {
+        grassCount()--;
+      }
+    }
+
+    // the chunks come from slabs instead of the heap
+    // note: the pool is never destroyed because chunks can outlive it at exit (e.g. in the global world object)
+    static SlabPool& pool() {
+      static SlabPool* slabPool = new SlabPool(sizeof(ChunkData_LevelDB), 4096);
+      return *slabPool;
+    }
+    static void* operator new(size_t size) {
+      if ( size > pool().getBlockSize() ) {
+        return ::operator new(size);
+      }
+      return pool().alloc();
+    }
+    static void operator delete(void* p, size_t size) {
+      if ( size > pool().getBlockSize() ) {
+        ::operator delete(p);
+        return;
+      }
+      pool().release(p);
+    }
+
+    static std::atomic<int64_t>& grassCount() {
+      static std::atomic<int64_t> ct(0);
+      return ct;
+    }
+
+    // number of top blocks whose id or data did not fit in the packed word (see setTopBlock)
+    static std::atomic<int64_t>& clipCount() {
+      static std::atomic<int64_t> ct(0);
+      return ct;
+    }
+
+    // the memory used by all of the chunks
+    static void getMemoryUse(int64_t& chunkCt, int64_t& bytes) {
+      chunkCt = pool().getLiveCount();
+      bytes = pool().getBytesReserved() + grassCount() * (int64_t)(16 * 16 * sizeof(uint32_t));
+    }
+
+    uint16_t getBlockId(int32_t cx, int32_t cz) const {
+      return topBlock[cx][cz] & kTopBlockIdMask;
+    }
+    uint8_t getBlockData(int32_t cx, int32_t cz) const {
+      return topBlock[cx][cz] >> kTopBlockIdBits;
+    }
+    // note: values that do not fit are clipped and counted (we warn about them after parsing)
+    void setTopBlock(int32_t cx, int32_t cz, int32_t blockId, int32_t blockData) {
+      if ( (uint32_t)blockId > kTopBlockIdMask || (uint32_t)blockData > kTopBlockDataMask ) {
+        clipCount()++;
+      }
+      topBlock[cx][cz] = (blockId & kTopBlockIdMask) | ((blockData & kTopBlockDataMask) << kTopBlockIdBits);
+    }
+    // number of columns that have a (non-air) top block
+    int32_t getTopBlockCount() const {
+      int32_t ct = 0;
+      for ( int32_t cx=0; cx < 16; cx++) {
+        for ( int32_t cz=0; cz < 16; cz++ ) {
+          if ( getBlockId(cx,cz) != 0 ) {
+            ct++;
+          }
+        }
+      }
+      return ct;
+    }
+
+    // grass and biome as found in the column data: grass color (high 24 bits) | biome id (low 8 bits)
+    void setGrassAndBiome(int32_t cx, int32_t cz, uint32_t v) {
+      biome[cx][cz] = v & 0xff;
+      if ( grass ) {
+        grass[cx * 16 + cz] = v >> 8;
+      }
+    }
+    uint32_t getGrass(int32_t cx, int32_t cz) const {
+      return grass ? grass[cx * 16 + cz] : 0;
+    }
+
     /*
       obsolete_ChunkData_LevelDB(int32_t chunkFormatVersion, int32_t tchunkX, int32_t tchunkY, int32_t tchunkZ, const char* cdata,
       int32_t dimensionId, const std::string& dimName,
@@ -1246,13 +1923,14 @@ namespace mcpe_viz {
                            Histogram& histogramGlobalBlock, Histogram& histogramGlobalBiome,
                            const bool* fastBlockHideList, const bool* fastBlockForceTopList,
                            const bool* fastBlockToGeoJSON,
-                           const CheckSpawnList& listCheckSpawn ) {
+                           const CheckSpawnList& listCheckSpawn,
+                           std::vector<std::string>& tlistGeoJSON ) {
       chunkX = tchunkX;
       chunkZ = tchunkZ;
       chunkFormatVersion = 2;
       
-      int16_t histogramBlock[512];
-      int16_t histogramBiome[256];
+      int32_t histogramBlock[512];
+      int32_t histogramBiome[256];
       memset(histogramBlock, 0, sizeof(histogramBlock));
       memset(histogramBiome, 0, sizeof(histogramBiome));
 
@@ -1286,26 +1964,9 @@ namespace mcpe_viz {
             
             // todobig - handle block variant?
             if ( fastBlockToGeoJSON[blockId] ) {
-              double ix, iy;
-              char tmpstring[512];
-              worldPointToGeoJSONPoint(dimensionId, chunkX*16 + cx, chunkZ*16 + cz, ix,iy);
-              sprintf(tmpstring, ""
-                      "\"Name\": \"%s\", "
-                      "\"Block\": true, "
-                      "\"Dimension\": \"%d\", "
-                      "\"Pos\": [%d, %d, %d]"
-                      "} }"
-                      , blockInfoList[blockId].name.c_str()
-                      , dimensionId
-                      , chunkX*16 + cx
-                      , cy
-                      , chunkZ*16 + cz
-                      );
-              std::string json = ""
-                + makeGeojsonHeader(ix,iy)
-                + tmpstring
-                ;
-              listGeoJSON.push_back( json );
+              std::string json = makeGeojsonHeaderWorld(dimensionId, chunkX*16 + cx, chunkZ*16 + cz);
+              appendGeojsonBlock(json, blockId, dimensionId, chunkX*16 + cx, cy, chunkZ*16 + cz);
+              tlistGeoJSON.push_back( json );
             }
 
             // check spawnable -- cannot check spawn at 0 or MAX_BLOCK_HEIGHT because we need above/below blocks
@@ -1347,27 +2008,9 @@ namespace mcpe_viz {
                       uint8_t bl = getBlockBlockLight_LevelDB_v2(cdata, cx,cz,cy);
                       if ( bl <= 7 ) {
                         // spwawnable! add it to the list
-                        double ix, iy;
-                        char tmpstring[512];
-                        worldPointToGeoJSONPoint(dimensionId, chunkX*16 + cx, chunkZ*16 + cz, ix,iy);
-                        sprintf(tmpstring, ""
-                                "\"Spawnable\":true,"
-                                "\"Name\":\"Spawnable\","
-                                "\"LightLevel\":\"%d\","
-                                "\"Dimension\":\"%d\","
-                                "\"Pos\":[%d,%d,%d]"
-                                "}}"
-                                , (int)bl
-                                , dimensionId
-                                , chunkX*16 + cx
-                                , cy
-                                , chunkZ*16 + cz
-                                );
-                        std::string json = ""
-                          + makeGeojsonHeader(ix,iy)
-                          + tmpstring
-                          ;
-                        listGeoJSON.push_back( json );
+                        std::string json = makeGeojsonHeaderWorld(dimensionId, chunkX*16 + cx, chunkZ*16 + cz);
+                        appendGeojsonSpawnable(json, bl, dimensionId, chunkX*16 + cx, cy, chunkZ*16 + cz);
+                        tlistGeoJSON.push_back( json );
                       }
                     }
                   }
@@ -1378,12 +2021,11 @@ namespace mcpe_viz {
             // todo - check for isSolid?
 
             if ( blockId != 0 ) {  // current block is NOT air
-              if ( ( blocks[cx][cz] == 0 &&  // top block is not already set
+              if ( ( getBlockId(cx,cz) == 0 &&  // top block is not already set
                      !fastBlockHideList[blockId] ) ||
                    fastBlockForceTopList[blockId] ) {
                 
-                blocks[cx][cz] = blockId;
-                data[cx][cz] = getBlockData_LevelDB_v2(cdata, cx,cz,cy);
+                setTopBlock(cx,cz, blockId, getBlockData_LevelDB_v2(cdata, cx,cz,cy));
                 topBlockY[cx][cz] = cy;
                 
 #if 1
@@ -1412,9 +2054,9 @@ namespace mcpe_viz {
       for (int32_t cx=0; cx < 16; cx++) {
         for (int32_t cz=0; cz < 16; cz++) {
           heightCol[cx][cz] = getColData_Height_LevelDB_v2(cdata, cx,cz);
-          grassAndBiome[cx][cz] = getColData_GrassAndBiome_LevelDB_v2(cdata, cx,cz);
+          setGrassAndBiome(cx,cz, getColData_GrassAndBiome_LevelDB_v2(cdata, cx,cz));
           
-          biomeId = (uint8_t)(grassAndBiome[cx][cz] & 0xFF);
+          biomeId = biome[cx][cz];
           histogramBiome[biomeId]++;
           histogramGlobalBiome.add(biomeId);
           
@@ -1436,12 +2078,10 @@ namespace mcpe_viz {
       // print chunk info
       logger.msg(kLogInfo1,"Top Blocks (block-id:block-data:biome-id):\n");
       // note the different use of cx/cz here
-      uint32_t rawData;
       for (int32_t cz=0; cz<16; cz++) {
         for (int32_t cx=0; cx<16; cx++) {
-          rawData = grassAndBiome[cx][cz];
-          biomeId = (uint8_t)(rawData & 0xFF);
-          logger.msg(kLogInfo1,"%03x:%x:%02x ", (int)blocks[cx][cz], (int)data[cx][cz], (int)biomeId);
+          biomeId = biome[cx][cz];
+          logger.msg(kLogInfo1,"%03x:%x:%02x ", (int)getBlockId(cx,cz), (int)getBlockData(cx,cz), (int)biomeId);
         }
         logger.msg(kLogInfo1,"\n");
       }
@@ -1470,20 +2110,67 @@ namespace mcpe_viz {
     }
 
 
+    // find the top block of each column in a sub-chunk -- we walk each column down from the top, so a column
+    // normally stops at its first visible block
+    // note: this gives the same result as checking each block from the bottom up: the highest force-top block wins;
+    // otherwise the highest visible block wins (unless the column already has a force-top block)
+    template <class GetBlockFunc, class SetTopFunc>
+    void scanTopBlocks ( int32_t chunkY, const bool* fastBlockHideList, const bool* fastBlockForceTopList,
+                         GetBlockFunc getBlock, SetTopFunc setTop ) {
+      // todo - param? forcetop is rarely used, and without it we never need to look below the first visible block
+      const bool forceTopFlag = memchr(fastBlockForceTopList, true, 512) != nullptr;
+      
+      for ( int32_t cx=0; cx < 16; cx++) {
+        for ( int32_t cz=0; cz < 16; cz++ ) {
+          int32_t topCy = -1, topId = 0;
+          int32_t forceCy = -1, forceId = 0;
+          for (int32_t cy=15; cy >= 0; cy--) {
+            int32_t blockId = getBlock(cx,cz,cy);
+            if ( blockId == 0 ) {
+              continue;
+            }
+            if ( fastBlockForceTopList[blockId] ) {
+              forceCy = cy;
+              forceId = blockId;
+              break;
+            }
+            if ( topCy < 0 && !fastBlockHideList[blockId] ) {
+              topCy = cy;
+              topId = blockId;
+              if ( ! forceTopFlag ) {
+                break;
+              }
+            }
+          }
+          
+          if ( forceCy >= 0 ) {
+            setTop(cx,cz,forceCy,forceId);
+          }
+          else if ( topCy >= 0 &&
+                    (chunkY*16 + topCy) >= topBlockY[cx][cz] &&
+                    !fastBlockForceTopList[ getBlockId(cx,cz) ] ) {
+            setTop(cx,cz,topCy,topId);
+          }
+        }
+      }
+    }
+
+    
     int32_t _do_chunk_v3 ( int32_t tchunkX, int32_t tchunkY, int32_t tchunkZ, const char* cdata, size_t cdata_size,
                            int32_t dimensionId, const std::string& dimName,
                            Histogram& histogramGlobalBlock, 
                            const bool* fastBlockHideList, const bool* fastBlockForceTopList,
                            const bool* fastBlockToGeoJSON,
-                           const CheckSpawnList& listCheckSpawn ) {
+                           const CheckSpawnList& listCheckSpawn,
+                           std::vector<std::string>& tlistGeoJSON ) {
       chunkX = tchunkX;
       int32_t chunkY = tchunkY;
       chunkZ = tchunkZ;
       chunkFormatVersion = 3;
       
       // todonow todostopper - this is problematic for cubic chunks
-      int16_t histogramBlock[512];
-      int16_t histogramBiome[256];
+      int32_t histogramBlock[512];
+      int32_t histogramBiome[256];
       memset(histogramBlock, 0, sizeof(histogramBlock));
       memset(histogramBiome, 0, sizeof(histogramBiome));
 
@@ -1517,68 +2204,44 @@ namespace mcpe_viz {
             
             // todobig - handle block variant?
             if ( fastBlockToGeoJSON[blockId] ) {
-              double ix, iy;
-              char tmpstring[512];
-              worldPointToGeoJSONPoint(dimensionId, chunkX*16 + cx, chunkZ*16 + cz, ix,iy);
-              sprintf(tmpstring, ""
-                      "\"Name\": \"%s\", "
-                      "\"Block\": true, "
-                      "\"Dimension\": \"%d\", "
-                      "\"Pos\": [%d, %d, %d]"
-                      "} }"
-                      , blockInfoList[blockId].name.c_str()
-                      , dimensionId
-                      , chunkX*16 + cx
-                      , chunkY*16 + cy
-                      , chunkZ*16 + cz
-                      );
-              std::string json = ""
-                + makeGeojsonHeader(ix,iy)
-                + tmpstring
-                ;
-              listGeoJSON.push_back( json );
+              std::string json = makeGeojsonHeaderWorld(dimensionId, chunkX*16 + cx, chunkZ*16 + cz);
+              appendGeojsonBlock(json, blockId, dimensionId, chunkX*16 + cx, chunkY*16 + cy, chunkZ*16 + cz);
+              tlistGeoJSON.push_back( json );
             }
 
             // note: we check spawnable later
-            
-            // todo - check for isSolid?
+          }
+        }
+      }
 
-            int32_t realy = chunkY*16 + cy;
-            if ( blockId != 0 ) {  // current block is NOT air
-              // todonow - this will break forcetop!
-              if ( ( realy >= topBlockY[cx][cz] &&
-                     !fastBlockForceTopList[ blocks[cx][cz] ] &&
-                     // blocks[cx][cz] == 0 &&  // top block is not already set
-                     !fastBlockHideList[blockId] ) ||
-                   fastBlockForceTopList[blockId] ) {
-                
-                blocks[cx][cz] = blockId;
-                data[cx][cz] = getBlockData_LevelDB_v3(cdata, cdata_size, cx,cz,cy);
-                topBlockY[cx][cz] = realy;
+      // find the top blocks
+      scanTopBlocks(chunkY, fastBlockHideList, fastBlockForceTopList
+                    , [&](int32_t cx, int32_t cz, int32_t cy) -> int32_t {
+                      return getBlockId_LevelDB_v3(cdata, cx,cz,cy);
+                    }
+                    , [&](int32_t cx, int32_t cz, int32_t cy, int32_t topId) {
+                      setTopBlock(cx,cz, topId, getBlockData_LevelDB_v3(cdata, cdata_size, cx,cz,cy));
+                      topBlockY[cx][cz] = chunkY*16 + cy;
 
-                int32_t cy2 = cy;
+                      int32_t cy2 = cy;
 
-                // todonow todohere todobig todostopper - can't do this until we have the whole chunk
+                      // todonow todohere todobig todostopper - can't do this until we have the whole chunk
 #if 1
-                // todo - we are getting the block light ABOVE this block (correct?)
-                // todo - this will break if we are using force-top stuff
-                if ( blockInfoList[blockId].isSolid() ) {
-                  // move to block above this block
-                  cy2++;
-                  if ( cy2 > MAX_BLOCK_HEIGHT ) { cy2 = MAX_BLOCK_HEIGHT; }
-                } else {
-                  // if not solid, don't adjust
-                }
+                      // todo - we are getting the block light ABOVE this block (correct?)
+                      // todo - this will break if we are using force-top stuff
+                      if ( blockInfoList[topId].isSolid() ) {
+                        // move to block above this block
+                        cy2++;
+                        if ( cy2 > MAX_BLOCK_HEIGHT ) { cy2 = MAX_BLOCK_HEIGHT; }
+                      } else {
+                        // if not solid, don't adjust
+                      }
 #endif
-                uint8_t sl = getBlockSkyLight_LevelDB_v3(cdata, cdata_size, cx,cz,cy2);
-                uint8_t bl = getBlockBlockLight_LevelDB_v3(cdata, cdata_size, cx,cz,cy2);   
-                // we combine the light nibbles into a byte
-                topLight[cx][cz] = (sl << 4) | bl;
-              }
-            }
-          }
-        }
-      }
+                      uint8_t sl = getBlockSkyLight_LevelDB_v3(cdata, cdata_size, cx,cz,cy2);
+                      uint8_t bl = getBlockBlockLight_LevelDB_v3(cdata, cdata_size, cx,cz,cy2);   
+                      // we combine the light nibbles into a byte
+                      topLight[cx][cz] = (sl << 4) | bl;
+                    });
 
       if ( control.quietFlag ) {
         return 0;
@@ -1590,12 +2253,10 @@ namespace mcpe_viz {
         // print chunk info
         logger.msg(kLogInfo1,"Top Blocks (block-id:block-data:biome-id):\n");
         // note the different use of cx/cz here
-        uint32_t rawData;
         for (int32_t cz=0; cz<16; cz++) {
           for (int32_t cx=0; cx<16; cx++) {
-            rawData = grassAndBiome[cx][cz];
-            biomeId = (uint8_t)(rawData & 0xFF);
-            logger.msg(kLogInfo1,"%03x:%x:%02x ", (int)blocks[cx][cz], (int)data[cx][cz], (int)biomeId);
+            biomeId = biome[cx][cz];
+            logger.msg(kLogInfo1,"%03x:%x:%02x ", (int)getBlockId(cx,cz), (int)getBlockData(cx,cz), (int)biomeId);
           }
           logger.msg(kLogInfo1,"\n");
         }
@@ -1630,15 +2291,16 @@ namespace mcpe_viz {
                            Histogram& histogramGlobalBlock, 
                            const bool* fastBlockHideList, const bool* fastBlockForceTopList,
                            const bool* fastBlockToGeoJSON,
-                           const CheckSpawnList& listCheckSpawn ) {
+                           const CheckSpawnList& listCheckSpawn,
+                           std::vector<std::string>& tlistGeoJSON ) {
       chunkX = tchunkX;
       int32_t chunkY = tchunkY;
       chunkZ = tchunkZ;
       chunkFormatVersion = 7;
       
       // todonow todostopper - this is problematic for cubic chunks
-      int16_t histogramBlock[512];
-      int16_t histogramBiome[256];
+      int32_t histogramBlock[512];
+      int32_t histogramBiome[256];
       memset(histogramBlock, 0, sizeof(histogramBlock));
       memset(histogramBiome, 0, sizeof(histogramBiome));
 
@@ -1675,7 +2337,6 @@ namespace mcpe_viz {
       }
       
       // read chunk palette and associate old-school block id's
-      MyNbtTagList tagList;
       int xoff = offsetBlockInfoList + 6 + extraOffset;
       // debug
       if ( false ) {
@@ -1691,135 +2352,63 @@ namespace mcpe_viz {
                    , (unsigned int)cdata[offsetBlockInfoList + 5] & 0xff
                    );
       }
-      parseNbtQuiet(&cdata[xoff], cdata_size-xoff, cdata[offsetBlockInfoList + 3], tagList);
+      std::shared_ptr<const ChunkPalette> palette = readChunkPalette_v7(&cdata[xoff], cdata_size-xoff, cdata[offsetBlockInfoList + 3]);
       //parseNbt("chunk-palette",&cdata[xoff], cdata_size-xoff, tagList);
-
-      std::vector<int32_t> chunkBlockPalette_BlockId(tagList.size());
-      std::vector<int32_t> chunkBlockPalette_BlockData(tagList.size());
-      
-      for ( size_t i=0; i < tagList.size(); i++ ) { 
-        // check tagList
-        if ( tagList[i].second->get_type() == nbt::tag_type::Compound ) {
-          nbt::tag_compound tc = tagList[i].second->as<nbt::tag_compound>();
-
-          bool processedFlag = false;
-          if ( tc.has_key("name", nbt::tag_type::String) ) {
-            std::string bname = tc["name"].as<nbt::tag_string>().get();
-            if ( tc.has_key("val", nbt::tag_type::Short) ) {
-              int bdata = tc["val"].as<nbt::tag_short>().get();
-              
-              int32_t blockId, blockData;
-              if ( getBlockByUname(bname, blockId, blockData) == 0 ) {
-                chunkBlockPalette_BlockId[i] = blockId;
-                // todonow - correct?
-                chunkBlockPalette_BlockData[i] = bdata;
-              } else {
-                logger.msg(kLogWarning,"Did not find block uname '%s' in XML file\n", bname.c_str());
-                // todonow - reasonable?
-                chunkBlockPalette_BlockId[i] = 0;
-                chunkBlockPalette_BlockData[i] = 0;
-              }
-              processedFlag = true;
-            }
-          }
-          if ( ! processedFlag ) {
-            slogger.msg(kLogError,"(Safe) Did not find 'name' and/or 'val' tags in a chunk palette! (i=%d) (len=%d)\n"
-                        , (int)i, (int)tagList.size() );
-            //todozooz - dump tc to screen log
-          }
-        } else {
-          logger.msg(kLogWarning,"Unexpected NBT format in _do_chunk_v7\n");
-        }
-      }
           
       //todozooz -- new 16-bit block-id's (instead of 8-bit) are a BIG issue - this needs attention here
+      uint16_t paletteBlockIds[16*16*16];
+      if ( unpackBlockIds_LevelDB_v7(&cdata[2 + extraOffset], bitsPerBlock, paletteBlockIds) != 0 ) {
+        return -1;
+      }
+    
       // iterate over chunk space
-      uint8_t paletteBlockId, blockData, biomeId;
+      uint16_t paletteBlockId;
+      uint8_t biomeId;
       int32_t blockId;
       for (int32_t cy=0; cy < 16; cy++) {
         for ( int32_t cx=0; cx < 16; cx++) {
           for ( int32_t cz=0; cz < 16; cz++ ) {
-            paletteBlockId = getBlockId_LevelDB_v7(&cdata[2 + extraOffset], blocksPerWord, bitsPerBlock, cx,cz,cy);
+            paletteBlockId = paletteBlockIds[_calcOffsetBlock_LevelDB_v7(cx,cz,cy)];
 
             // look up blockId
             //todonow error checking
-            if ( paletteBlockId < chunkBlockPalette_BlockId.size() ) {
-              blockId = chunkBlockPalette_BlockId[paletteBlockId];
-              blockData = chunkBlockPalette_BlockData[paletteBlockId];
+            if ( paletteBlockId < palette->blockId.size() ) {
+              blockId = palette->blockId[paletteBlockId];
             } else {
               blockId = 0;
-              blockData = 0;
-              logger.msg(kLogWarning,"Found chunk palette id out of range %d (size=%d)\n", paletteBlockId, (int)chunkBlockPalette_BlockId.size());
+              logger.msg(kLogWarning,"Found chunk palette id out of range %d (size=%d)\n", paletteBlockId, (int)palette->blockId.size());
             }
             histogramBlock[blockId]++;
             histogramGlobalBlock.add(blockId);
             
             // todobig - handle block variant?
             if ( fastBlockToGeoJSON[blockId] ) {
-              double ix, iy;
-              char tmpstring[512];
-              worldPointToGeoJSONPoint(dimensionId, chunkX*16 + cx, chunkZ*16 + cz, ix,iy);
-              sprintf(tmpstring, ""
-                      "\"Name\": \"%s\", "
-                      "\"Block\": true, "
-                      "\"Dimension\": \"%d\", "
-                      "\"Pos\": [%d, %d, %d]"
-                      "} }"
-                      , blockInfoList[blockId].name.c_str()
-                      , dimensionId
-                      , chunkX*16 + cx
-                      , chunkY*16 + cy
-                      , chunkZ*16 + cz
-                      );
-              std::string json = ""
-                + makeGeojsonHeader(ix,iy)
-                + tmpstring
-                ;
-              listGeoJSON.push_back( json );
+              std::string json = makeGeojsonHeaderWorld(dimensionId, chunkX*16 + cx, chunkZ*16 + cz);
+              appendGeojsonBlock(json, blockId, dimensionId, chunkX*16 + cx, chunkY*16 + cy, chunkZ*16 + cz);
+              tlistGeoJSON.push_back( json );
             }
 
             // note: we check spawnable later
-            
-            // todo - check for isSolid?
-
-            int32_t realy = chunkY*16 + cy;
-            if ( blockId != 0 ) {  // current block is NOT air
-              // todonow - this will break forcetop!
-              if ( ( realy >= topBlockY[cx][cz] &&
-                     !fastBlockForceTopList[ blocks[cx][cz] ] &&
-                     // blocks[cx][cz] == 0 &&  // top block is not already set
-                     !fastBlockHideList[blockId] ) ||
-                   fastBlockForceTopList[blockId] ) {
-                
-                blocks[cx][cz] = blockId;
-                data[cx][cz] = blockData; // getBlockData_LevelDB_v3(cdata, cdata_size, cx,cz,cy);
-                topBlockY[cx][cz] = realy;
-
-                int32_t cy2 = cy;
-
-                // todonow todohere todobig todostopper - can't do this until we have the whole chunk
-#if 1
-                // todo - we are getting the block light ABOVE this block (correct?)
-                // todo - this will break if we are using force-top stuff
-                if ( blockInfoList[blockId].isSolid() ) {
-                  // move to block above this block
-                  cy2++;
-                  if ( cy2 > MAX_BLOCK_HEIGHT ) { cy2 = MAX_BLOCK_HEIGHT; }
-                } else {
-                  // if not solid, don't adjust
-                }
-#endif
-                // todonow todohere -- no blocklight or skylight in v7 chunks?!
-                uint8_t sl = 0; // getBlockSkyLight_LevelDB_v3(cdata, cdata_size, cx,cz,cy2);
-                uint8_t bl = 0; // getBlockBlockLight_LevelDB_v3(cdata, cdata_size, cx,cz,cy2);   
-                // we combine the light nibbles into a byte
-                topLight[cx][cz] = (sl << 4) | bl;
-              }
-            }
           }
         }
       }
 
+      // find the top blocks
+      const size_t paletteSize = palette->blockId.size();
+      scanTopBlocks(chunkY, fastBlockHideList, fastBlockForceTopList
+                    , [&](int32_t cx, int32_t cz, int32_t cy) -> int32_t {
+                      uint16_t i = paletteBlockIds[_calcOffsetBlock_LevelDB_v7(cx,cz,cy)];
+                      return ( i < paletteSize ) ? palette->blockId[i] : 0;
+                    }
+                    , [&](int32_t cx, int32_t cz, int32_t cy, int32_t topId) {
+                      uint16_t i = paletteBlockIds[_calcOffsetBlock_LevelDB_v7(cx,cz,cy)];
+                      setTopBlock(cx,cz, topId, palette->blockData[i]);
+                      topBlockY[cx][cz] = chunkY*16 + cy;
+
+                      // todonow todohere -- no blocklight or skylight in v7 chunks?!
+                      topLight[cx][cz] = 0;
+                    });
+
       if ( control.quietFlag ) {
         return 0;
       }
@@ -1830,12 +2419,10 @@ namespace mcpe_viz {
         // print chunk info
         logger.msg(kLogInfo1,"Top Blocks (block-id:block-data:biome-id):\n");
         // note the different use of cx/cz here
-        uint32_t rawData;
         for (int32_t cz=0; cz<16; cz++) {
           for (int32_t cx=0; cx<16; cx++) {
-            rawData = grassAndBiome[cx][cz];
-            biomeId = (uint8_t)(rawData & 0xFF);
-            logger.msg(kLogInfo1,"%03x:%x:%02x ", (int)blocks[cx][cz], (int)data[cx][cz], (int)biomeId);
+            biomeId = biome[cx][cz];
+            logger.msg(kLogInfo1,"%03x:%x:%02x ", (int)getBlockId(cx,cz), (int)getBlockData(cx,cz), (int)biomeId);
           }
           logger.msg(kLogInfo1,"\n");
         }
@@ -1887,7 +2474,7 @@ namespace mcpe_viz {
         logger.msg(kLogInfo1, "\n");
       }
       
-      int16_t histogramBiome[256];
+      int32_t histogramBiome[256];
       memset(histogramBiome, 0, sizeof(histogramBiome));
 
       // get per-column data
@@ -1895,9 +2482,9 @@ namespace mcpe_viz {
       for (int32_t cx=0; cx < 16; cx++) {
         for (int32_t cz=0; cz < 16; cz++) {
           heightCol[cx][cz] = getColData_Height_LevelDB_v3(cdata, cx,cz);
-          grassAndBiome[cx][cz] = getColData_GrassAndBiome_LevelDB_v3(cdata, cdatalen, cx,cz);
+          setGrassAndBiome(cx,cz, getColData_GrassAndBiome_LevelDB_v3(cdata, cdatalen, cx,cz));
           
-          biomeId = (uint8_t)(grassAndBiome[cx][cz] & 0xFF);
+          biomeId = biome[cx][cz];
           histogramBiome[biomeId]++;
           histogramGlobalBiome.add(biomeId);
           
@@ -2045,26 +2632,10 @@ namespace mcpe_viz {
                       if ( bl <= 7 ) {
                         // spwawnable! add it to the list
                         double ix, iy;
-                        char tmpstring[512];
                         worldPointToGeoJSONPoint(dimId, chunkX*16 + cx, chunkZ*16 + cz, ix,iy);
-                        sprintf(tmpstring, ""
-                                "\"Spawnable\":true,"
-                                "\"Name\":\"Spawnable\","
-                                "\"LightLevel\":\"%d\","
-                                "\"Dimension\":\"%d\","
-                                "\"Pos\":[%d,%d,%d]"
-                                "}}"
-                                , (int)bl
-                                , dimId
-                                , chunkX*16 + cx
-                                , cy
-                                , chunkZ*16 + cz
-                                );
-                        std::string json = ""
-                          + makeGeojsonHeader(ix,iy)
-                          + tmpstring
-                          ;
-                        listGeoJSON.push_back( json );
+                        std::string json = makeGeojsonHeader(ix,iy);
+                        appendGeojsonSpawnable(json, bl, dimId, chunkX*16 + cx, cy, chunkZ*16 + cz);
+                        geojsonSink.add( json );
                       }
                     }
                   }
@@ -2083,7 +2654,203 @@ namespace mcpe_viz {
     }
   };
 
-  
+  typedef std::pair<uint32_t, uint32_t> ChunkKey;
+  // note: shared_ptr because with --chunk-cache a chunk is shared by the dimension and the chunk cache (not copied)
+  typedef std::map< ChunkKey, std::shared_ptr<ChunkData_LevelDB> > ChunkData_LevelDB_Map;
+
+
+  // a dense index over the chunks of a dimension so that making images is a linear scan instead of map lookups
+  // note: the grid is made of regions (16x16 chunks) and we only allocate the regions that have chunks in them,
+  //   so worlds with a few far-flung chunks do not need a huge grid
+  class ChunkGrid {
+  private:
+    static const int32_t kRegionShift = 4;
+    static const int32_t kRegionSize = (1 << kRegionShift);
+    static const int32_t kRegionMask = (kRegionSize - 1);
+    typedef std::array<const ChunkData_LevelDB*, kRegionSize * kRegionSize> Region;
+
+    int32_t minChunkX, minChunkZ;
+    int32_t chunkW, chunkH;
+    int32_t regionW, regionH;
+    std::vector< std::unique_ptr<Region> > regions;
+
+  public:
+    ChunkGrid() {
+      minChunkX = minChunkZ = 0;
+      chunkW = chunkH = 0;
+      regionW = regionH = 0;
+    }
+
+    void clear() {
+      regions.clear();
+      chunkW = chunkH = 0;
+      regionW = regionH = 0;
+    }
+    
+    // note: chunks outside of the bounds are left out
+    int32_t build(const ChunkData_LevelDB_Map& chunks, int32_t tminChunkX, int32_t tminChunkZ, int32_t maxChunkX, int32_t maxChunkZ) {
+      clear();
+      minChunkX = tminChunkX;
+      minChunkZ = tminChunkZ;
+      chunkW = maxChunkX - minChunkX + 1;
+      chunkH = maxChunkZ - minChunkZ + 1;
+      if ( chunkW <= 0 || chunkH <= 0 ) {
+        chunkW = chunkH = 0;
+        return -1;
+      }
+      regionW = (chunkW + kRegionMask) >> kRegionShift;
+      regionH = (chunkH + kRegionMask) >> kRegionShift;
+      regions.resize( (size_t)regionW * (size_t)regionH );
+      
+      for ( const auto& it : chunks ) {
+        int32_t gx = it.second->chunkX - minChunkX;
+        int32_t gz = it.second->chunkZ - minChunkZ;
+        if ( gx < 0 || gz < 0 || gx >= chunkW || gz >= chunkH ) {
+          continue;
+        }
+        std::unique_ptr<Region>& region = regions[ (size_t)(gz >> kRegionShift) * regionW + (gx >> kRegionShift) ];
+        if ( ! region ) {
+          region = std::unique_ptr<Region>(new Region());
+          region->fill(nullptr);
+        }
+        (*region)[ (gz & kRegionMask) * kRegionSize + (gx & kRegionMask) ] = it.second.get();
+      }
+      return 0;
+    }
+
+    // returns nullptr if there is no chunk here
+    const ChunkData_LevelDB* get(int32_t chunkX, int32_t chunkZ) const {
+      int32_t gx = chunkX - minChunkX;
+      int32_t gz = chunkZ - minChunkZ;
+      if ( gx < 0 || gz < 0 || gx >= chunkW || gz >= chunkH ) {
+        return nullptr;
+      }
+      const std::unique_ptr<Region>& region = regions[ (size_t)(gz >> kRegionShift) * regionW + (gx >> kRegionShift) ];
+      if ( ! region ) {
+        return nullptr;
+      }
+      return (*region)[ (gz & kRegionMask) * kRegionSize + (gx & kRegionMask) ];
+    }
+  };
+
+
+  // serial groups for output tasks (see OutputTaskList)
+  enum OutputGroup : int32_t {
+    kOutputGroupStart = 0,
+      kOutputGroupFinish = 1
+      };
+
+  // --threads: a list of output tasks (e.g. the images of each dimension) that can be done at the same time
+  // note: the log output of each task is captured and replayed in task order so that the output is
+  //   identical to the single-threaded output
+  class OutputTaskList {
+  private:
+    class OutputTask {
+    public:
+      std::function<void()> func;
+      // the task does not start until these tasks are done
+      std::vector<size_t> waitFor;
+      LogCaptureList log;
+      bool doneFlag;
+
+      OutputTask() {
+        doneFlag = false;
+      }
+    };
+
+    std::vector< std::unique_ptr<OutputTask> > tasks;
+    std::map<int32_t, size_t> serialGroupLast;
+    std::mutex mtx;
+    std::condition_variable cv;
+    size_t nextTask;
+
+    bool isReady(const OutputTask& task) {
+      for ( const auto& it : task.waitFor ) {
+        if ( ! tasks[it]->doneFlag ) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+  public:
+    OutputTaskList() {
+      nextTask = 0;
+    }
+
+    // returns the index of the new task
+    // note: a task in a serial group (>= 0) also waits for the previous task in that group
+    size_t add(const std::function<void()>& func, const std::vector<size_t>& waitFor, int32_t serialGroup) {
+      std::unique_ptr<OutputTask> task(new OutputTask());
+      task->func = func;
+      task->waitFor = waitFor;
+      size_t index = tasks.size();
+      if ( serialGroup >= 0 ) {
+        const auto& it = serialGroupLast.find(serialGroup);
+        if ( it != serialGroupLast.end() ) {
+          task->waitFor.push_back(it->second);
+        }
+        serialGroupLast[serialGroup] = index;
+      }
+      tasks.push_back(std::move(task));
+      return index;
+    }
+
+    size_t add(const std::function<void()>& func) {
+      return add(func, std::vector<size_t>(), -1);
+    }
+
+    int32_t run(int32_t threadCount) {
+      // we do the tasks in order on this thread
+      if ( threadCount <= 1 || tasks.size() <= 1 ) {
+        for ( auto& it : tasks ) {
+          it->func();
+          it->doneFlag = true;
+        }
+        return 0;
+      }
+
+      // note: workers take the tasks in order, so a task only waits for tasks that are already running
+      std::vector<std::thread> workers;
+      for (int32_t i=0; i < threadCount; i++) {
+        workers.push_back(std::thread([this]() {
+              while ( true ) {
+                OutputTask* task;
+                {
+                  std::unique_lock<std::mutex> lock(mtx);
+                  if ( nextTask >= tasks.size() ) {
+                    break;
+                  }
+                  task = tasks[nextTask++].get();
+                  cv.wait(lock, [this,task]() { return isReady(*task); });
+                }
+                Logger::setCapture(&task->log);
+                task->func();
+                Logger::setCapture(nullptr);
+                std::unique_lock<std::mutex> lock(mtx);
+                task->doneFlag = true;
+                cv.notify_all();
+              }
+            }));
+      }
+
+      // replay the log output as the tasks finish
+      for ( auto& it : tasks ) {
+        {
+          std::unique_lock<std::mutex> lock(mtx);
+          cv.wait(lock, [&it]() { return it->doneFlag; });
+        }
+        Logger::replayCapture(it->log);
+        it->log.clear();
+      }
+
+      for ( auto& it : workers ) {
+        it.join();
+      }
+      return 0;
+    }
+  };
+
 
   class DimensionData {
   public:
@@ -2094,9 +2861,9 @@ namespace mcpe_viz {
     std::string name;
     int32_t dimId;
 
-    typedef std::pair<uint32_t, uint32_t> ChunkKey;
-    typedef std::map< ChunkKey, std::unique_ptr<ChunkData_LevelDB> > ChunkData_LevelDB_Map;
     ChunkData_LevelDB_Map chunks;
+    // made from chunks when we make the images
+    ChunkGrid chunkGrid;
 
     int32_t minChunkX, maxChunkX;
     int32_t minChunkZ, maxChunkZ;
@@ -2110,6 +2877,9 @@ namespace mcpe_viz {
     bool fastBlockHideList[512];
     bool fastBlockToGeoJSONList[512];
 
+    // --direct-tiles with --chunk-cache: only these tiles need to be written (nullptr == all tiles)
+    const TileSet* dirtyTiles;
+
     // convenience vars from world object
     std::string worldName;
     int32_t worldSpawnX, worldSpawnZ;
@@ -2137,6 +2907,7 @@ namespace mcpe_viz {
       minChunkZ = 0;
       maxChunkZ = 0;
       memset(histogramChunkType,0,sizeof(histogramChunkType));
+      dirtyTiles = nullptr;
       worldName = "(UNKNOWN)";
       worldSpawnX = worldSpawnZ = 0;
       worldSeed = 0;
@@ -2157,9 +2928,31 @@ namespace mcpe_viz {
       }
     }
 
+    // --top-only: force-top and geojson-block need to see every block
+    bool getTopOnlyOk() const {
+      return blockForceTopList.empty() && blockToGeoJSONList.empty();
+    }
+
+    // --chunk-cache: the settings that change how chunks are decoded
+    uint64_t hashDecodeSettings(uint64_t h) {
+      h = hashBytes(h, (const char*)fastBlockForceTopList, sizeof(fastBlockForceTopList));
+      h = hashBytes(h, (const char*)fastBlockHideList, sizeof(fastBlockHideList));
+      h = hashBytes(h, (const char*)fastBlockToGeoJSONList, sizeof(fastBlockToGeoJSONList));
+      for ( const auto& it : listCheckSpawn ) {
+        h = hashBytes(h, (const char*)&it->x, sizeof(it->x));
+        h = hashBytes(h, (const char*)&it->z, sizeof(it->z));
+        h = hashBytes(h, (const char*)&it->distance, sizeof(it->distance));
+      }
+      return h;
+    }
+
     void setName(const std::string& s) {
       name = s;
     }
+
+    void setDirtyTiles(const TileSet* tiles) {
+      dirtyTiles = tiles;
+    }
     const std::string& getName() const {
       return name;
     }
@@ -2216,40 +3009,50 @@ namespace mcpe_viz {
     int32_t getMaxChunkZ() { return maxChunkZ; }
 
     int32_t addChunk ( int32_t tchunkFormatVersion, int32_t chunkX, int32_t chunkY, int32_t chunkZ, const char* cdata, size_t cdata_size) {
+      std::vector<std::string> tlistGeoJSON;
+      int32_t ret = addChunk(chunks, histogramGlobalBlock, histogramGlobalBiome, tlistGeoJSON,
+                             tchunkFormatVersion, chunkX, chunkY, chunkZ, cdata, cdata_size);
+      geojsonSink.add(tlistGeoJSON);
+      return ret;
+    }
+
+    // note: this variant is used by the dbParse worker threads (--threads) -- the caller owns the chunk map, histograms and geojson list
+    int32_t addChunk ( ChunkData_LevelDB_Map& tchunks, Histogram& hBlock, Histogram& hBiome, std::vector<std::string>& tlistGeoJSON,
+                       int32_t tchunkFormatVersion, int32_t chunkX, int32_t chunkY, int32_t chunkZ, const char* cdata, size_t cdata_size) {
       ChunkKey chunkKey(chunkX, chunkZ);
       switch ( tchunkFormatVersion ) {
       case 2:
         // pre-0.17
-        chunks[chunkKey] = std::unique_ptr<ChunkData_LevelDB>( new ChunkData_LevelDB() );
-        return chunks[chunkKey]->_do_chunk_v2(chunkX, chunkZ, cdata, dimId, name,
-                                              histogramGlobalBlock, histogramGlobalBiome,
-                                              fastBlockHideList, fastBlockForceTopList, fastBlockToGeoJSONList,
-                                              listCheckSpawn);
+        tchunks[chunkKey] = std::shared_ptr<ChunkData_LevelDB>( new ChunkData_LevelDB() );
+        return tchunks[chunkKey]->_do_chunk_v2(chunkX, chunkZ, cdata, dimId, name,
+                                               hBlock, hBiome,
+                                               fastBlockHideList, fastBlockForceTopList, fastBlockToGeoJSONList,
+                                               listCheckSpawn, tlistGeoJSON);
         return 0;
       case 3:
         // 0.17 and later?
         // we need to process all sub-chunks, not just blindy add them
         
-        if ( !chunks_has_key(chunks, chunkKey) ) {
-          chunks[chunkKey] = std::unique_ptr<ChunkData_LevelDB>( new ChunkData_LevelDB() );
+        if ( !chunks_has_key(tchunks, chunkKey) ) {
+          tchunks[chunkKey] = std::shared_ptr<ChunkData_LevelDB>( new ChunkData_LevelDB() );
         }
         
-        return chunks[chunkKey]->_do_chunk_v3(chunkX, chunkY, chunkZ, cdata, cdata_size, dimId, name,
-                                              histogramGlobalBlock, 
-                                              fastBlockHideList, fastBlockForceTopList, fastBlockToGeoJSONList,
-                                              listCheckSpawn);
+        return tchunks[chunkKey]->_do_chunk_v3(chunkX, chunkY, chunkZ, cdata, cdata_size, dimId, name,
+                                               hBlock, 
+                                               fastBlockHideList, fastBlockForceTopList, fastBlockToGeoJSONList,
+                                               listCheckSpawn, tlistGeoJSON);
       case 7:
         // 1.2.x betas?
         // we need to process all sub-chunks, not just blindy add them
         
-        if ( !chunks_has_key(chunks, chunkKey) ) {
-          chunks[chunkKey] = std::unique_ptr<ChunkData_LevelDB>( new ChunkData_LevelDB() );
+        if ( !chunks_has_key(tchunks, chunkKey) ) {
+          tchunks[chunkKey] = std::shared_ptr<ChunkData_LevelDB>( new ChunkData_LevelDB() );
         }
         
-        return chunks[chunkKey]->_do_chunk_v7(chunkX, chunkY, chunkZ, cdata, cdata_size, dimId, name,
-                                              histogramGlobalBlock, 
-                                              fastBlockHideList, fastBlockForceTopList, fastBlockToGeoJSONList,
-                                              listCheckSpawn);
+        return tchunks[chunkKey]->_do_chunk_v7(chunkX, chunkY, chunkZ, cdata, cdata_size, dimId, name,
+                                               hBlock, 
+                                               fastBlockHideList, fastBlockForceTopList, fastBlockToGeoJSONList,
+                                               listCheckSpawn, tlistGeoJSON);
         return 0;
       }
       slogger.msg(kLogError, "UNKNOWN CHUNK FORMAT (%d)\n", tchunkFormatVersion);
@@ -2257,6 +3060,11 @@ namespace mcpe_viz {
     }
     
     int32_t addChunkColumnData ( int32_t tchunkFormatVersion, int32_t chunkX, int32_t chunkZ, const char* cdata, int32_t cdatalen) {
+      return addChunkColumnData(chunks, histogramGlobalBiome, tchunkFormatVersion, chunkX, chunkZ, cdata, cdatalen);
+    }
+    
+    int32_t addChunkColumnData ( ChunkData_LevelDB_Map& tchunks, Histogram& hBiome,
+                                 int32_t tchunkFormatVersion, int32_t chunkX, int32_t chunkZ, const char* cdata, int32_t cdatalen) {
       switch ( tchunkFormatVersion ) {
       case 2:
         // pre-0.17
@@ -2267,15 +3075,26 @@ namespace mcpe_viz {
         // we need to process all sub-chunks, not just blindy add them
 
         ChunkKey chunkKey(chunkX, chunkZ);
-        if ( !chunks_has_key(chunks, chunkKey) ) {
-          chunks[chunkKey] = std::unique_ptr<ChunkData_LevelDB>( new ChunkData_LevelDB() );
+        if ( !chunks_has_key(tchunks, chunkKey) ) {
+          tchunks[chunkKey] = std::shared_ptr<ChunkData_LevelDB>( new ChunkData_LevelDB() );
         }
 
-        return chunks[chunkKey]->_do_chunk_biome_v3(chunkX, chunkZ, cdata, cdatalen, histogramGlobalBiome);
+        return tchunks[chunkKey]->_do_chunk_biome_v3(chunkX, chunkZ, cdata, cdatalen, hBiome);
       }
       slogger.msg(kLogError, "UNKNOWN CHUNK FORMAT (%d)\n", tchunkFormatVersion);
       return -1;
     }
+
+    // move chunks decoded by a dbParse worker thread into this dimension
+    // note: batches never split a chunk column, so a chunk is never in more than one batch
+    void mergeChunks ( ChunkData_LevelDB_Map& tchunks, const Histogram& hBlock, const Histogram& hBiome ) {
+      for ( auto& it : tchunks ) {
+        chunks[it.first] = std::move(it.second);
+      }
+      tchunks.clear();
+      histogramGlobalBlock.merge(hBlock);
+      histogramGlobalBiome.merge(hBiome);
+    }
     
     int32_t checkSpawnable ( leveldb::DB* db ) {
       for (const auto& it : chunks) {
@@ -2367,9 +3186,13 @@ namespace mcpe_viz {
       hvector = histogramGlobalBlock.sort(1);
       for (auto& it : hvector ) {
         int32_t k = it.first;
-        int32_t v = it.second;
+        int64_t v = it.second;
         double pct = ((double)v / htotal) * 100.0;
-        logger.msg(kLogInfo1,"hg-globalblock: 0x%02x %10d %7.3lf%% %s\n", k, v, pct, blockInfoList[k].name.c_str());
+        if ( k == Histogram::kOverflowKey ) {
+          logger.msg(kLogInfo1,"hg-globalblock: overflow %10lld %7.3lf%% (block id's outside 0..%d)\n", (long long int)v, pct, Histogram::kSize-1);
+          continue;
+        }
+        logger.msg(kLogInfo1,"hg-globalblock: 0x%02x %10lld %7.3lf%% %s\n", k, (long long int)v, pct, blockInfoList[k].name.c_str());
       }
 
       logger.msg(kLogInfo1,"\nGlobal Biome Histogram (biome-id count pct name):\n");
@@ -2377,10 +3200,14 @@ namespace mcpe_viz {
       hvector = histogramGlobalBiome.sort(1);
       for (auto& it : hvector ) {
         int32_t k = it.first;
-        int32_t v = it.second;
+        int64_t v = it.second;
         double pct = ((double)v / htotal) * 100.0;
         //      logger.msg(kLogInfo1,"hg-globalbiome: 0x%02x %10d %7.3lf%% %s\n", k, v, pct, biomeInfoList[k]->name.c_str());
-        logger.msg(kLogInfo1,"hg-globalbiome: 0x%02x %10d %7.3lf%%\n", k, v, pct);
+        if ( k == Histogram::kOverflowKey ) {
+          logger.msg(kLogInfo1,"hg-globalbiome: overflow %10lld %7.3lf%% (biome id's outside 0..%d)\n", (long long int)v, pct, Histogram::kSize-1);
+          continue;
+        }
+        logger.msg(kLogInfo1,"hg-globalbiome: 0x%02x %10lld %7.3lf%%\n", k, (long long int)v, pct);
       }
     }
 
@@ -2461,34 +3288,175 @@ namespace mcpe_viz {
 
     
     // todohere - rename - we are in "row(s) at a time" mode here
-    int32_t outputPNG_init(PngWriter& png, const std::string& fname, const std::string& imageDescription, int32_t width, int32_t height, bool rgbaFlag) {
-      if ( png.init(fname, imageDescription, width, height, height, rgbaFlag, false) != 0 ) {
+    // note: with --direct-tiles we write the tiles here and only write the full-size image if needFullImageFlag is set
+    // note: directTilesOkFlag=false always writes just the full-size image (it is tiled later by doOutput_Tile)
+    int32_t outputPNG_init(PngImageWriter& png, const std::string& fname, const std::string& imageDescription, int32_t width, int32_t height, bool rgbaFlag,
+                           bool needFullImageFlag = false, bool directTilesOkFlag = true) {
+      std::string dirTiles = "";
+      if ( control.useDirectTiles() && directTilesOkFlag ) {
+        dirTiles = mydirname(control.fnOutputBase) + "/tiles";
+        local_mkdir(dirTiles);
+      }
+      if ( png.init(fname, imageDescription, width, height, rgbaFlag, (dirTiles.size() == 0) || needFullImageFlag,
+                    dirTiles, control.tileWidth, control.tileHeight, dirtyTiles) != 0 ) {
         return -1;
       }
       return 0;
     }
 
-    int32_t outputPNG_writeRow(PngWriter& png, uint8_t* buf) {
-      png_write_row(png.png, buf);
-      // todo - check err?
-      return 0;
+    int32_t outputPNG_writeRow(PngImageWriter& png, uint8_t* buf) {
+      return png.writeRow(buf);
     }
 
-    int32_t outputPNG_writeRows(PngWriter& png, uint8_t** rows, uint32_t nrows) {
-      png_write_rows(png.png, rows, nrows);
-      // todo - check err?
-      return 0;
+    int32_t outputPNG_writeRows(PngImageWriter& png, uint8_t** rows, uint32_t nrows) {
+      return png.writeRows(rows, nrows);
     }
     
-    int32_t outputPNG_close(PngWriter& png) {
-      png.close();
-      // todo - check err?
-      return 0;
+    // note: this fails if any of the tiles could not be written (PngImageWriter::close logs them)
+    int32_t outputPNG_close(PngImageWriter& png) {
+      return png.close();
     }
 
     
     
-    int32_t generateImage(const std::string& fname, const ImageModeType imageMode) {
+    // an image for generateImages()
+    class ImageRequest {
+    public:
+      std::string fname;
+      ImageModeType imageMode;
+      bool needFullImageFlag;
+
+      ImageRequest(const std::string& fn, ImageModeType mode, bool tneedFullImageFlag)
+        : fname(fn)
+        , imageMode(mode)
+        , needFullImageFlag(tneedFullImageFlag) {
+      }
+    };
+
+    // the output state of one image in generateImages()
+    class ImageOutput {
+    public:
+      ImageModeType imageMode;
+      int32_t bpp;
+      uint8_t lut[256];
+      std::vector<uint8_t> buf;
+      uint8_t *rows[16];
+      PngImageWriter png;
+      bool okFlag;
+    };
+    
+    // get the color of one pixel of an image (same byte layout as the palettes: 0xRRGGBB00 in memory order, or RGBA)
+    int32_t getImagePixelColor(const ChunkData_LevelDB* it, int32_t cx, int32_t cz, const ImageOutput& out, int32_t* colorSetNeedCount) {
+      int32_t color;
+      
+      // todo - this big conditional inside an inner loop, not so good
+
+      if ( out.imageMode == kImageModeBiome ) {
+        // get biome color
+        int32_t biomeId = it->biome[cx][cz];
+        if ( has_key(biomeInfoList, biomeId) ) {
+          color = biomeInfoList[biomeId]->color;
+        } else {
+          slogger.msg(kLogInfo1,"ERROR: Unknown biome %d 0x%x\n", biomeId, biomeId);
+          color = htobe32(0xff2020);
+        }
+      }
+      else if ( out.imageMode == kImageModeGrass ) {
+        // get grass color
+        int32_t grassColor = it->getGrass(cx,cz);
+        color = htobe32(grassColor);
+      }
+      else if ( out.imageMode == kImageModeHeightCol ) {
+        // get height value and use red-black-green palette
+        if ( control.heightMode == kHeightModeTop ) {
+          uint8_t c = it->topBlockY[cx][cz];
+          color = palRedBlackGreen[c];
+        } else {
+          uint8_t c = it->heightCol[cx][cz];
+          color = palRedBlackGreen[c];
+        }
+      }
+      else if ( out.imageMode == kImageModeHeightColGrayscale ) {
+        // get height value and make it grayscale
+        if ( control.heightMode == kHeightModeTop ) {
+          uint8_t c = it->topBlockY[cx][cz];
+          color = (c << 24) | (c << 16) | (c << 8);
+        } else {
+          uint8_t c = it->heightCol[cx][cz];
+          color = (c << 24) | (c << 16) | (c << 8);
+        }
+      }
+      else if ( out.imageMode == kImageModeHeightColAlpha ) {
+        // get height value and make it alpha
+        uint8_t c;
+        if ( control.heightMode == kHeightModeTop ) {
+          c = it->topBlockY[cx][cz];
+        } else {
+          c = it->heightCol[cx][cz];
+        }
+        // c = (90 - (int32_t)it->heightCol[cx][cz]) * 2;
+        c = out.lut[c];
+        color = ((c & 0xff) << 24);
+      }
+      else if ( out.imageMode == kImageModeBlockLight ) {
+        // get block light value and expand it (is only 4-bits)
+        uint8_t c = (it->topLight[cx][cz] & 0x0f) << 4;
+        color = (c << 24) | (c << 16) | (c << 8);
+      }
+      else if ( out.imageMode == kImageModeSkyLight ) {
+        // get sky light value and expand it (is only 4-bits)
+        uint8_t c = (it->topLight[cx][cz] & 0xf0);
+        color = (c << 24) | (c << 16) | (c << 8);
+      }
+      else {
+        // regular image
+        int32_t blockid = it->getBlockId(cx,cz);
+                
+        if ( blockInfoList[blockid].hasVariants() ) {
+          // we need to get blockdata
+          int32_t blockdata = it->getBlockData(cx,cz);
+          bool vfound = false;
+          for (const auto& itbv : blockInfoList[blockid].variantList) {
+            if ( itbv->blockdata == blockdata ) {
+              vfound = true;
+              color = itbv->color;
+              break;
+            }
+          }
+          if ( ! vfound ) {
+            // todo - warn once per id/blockdata or the output volume could get ridiculous
+            slogger.msg(kLogInfo1,"WARNING: Did not find block variant for block (id=%d (0x%x) '%s') with blockdata=%d (0x%x) MSG1\n"
+                        , blockid, blockid
+                        , blockInfoList[blockid].name.c_str()
+                        , blockdata
+                        , blockdata
+                        );
+            // since we did not find the variant, use the parent block's color
+            color = blockInfoList[blockid].color;
+          }
+        } else {
+          color = blockInfoList[blockid].color;
+          if ( ! blockInfoList[blockid].colorSetFlag ) {
+            colorSetNeedCount[blockid]++;
+          }
+        }
+      }
+
+      // do grid lines
+      if ( checkDoForDim(control.doGrid) && (cx==0 || cz==0) ) {
+        if ( (it->chunkX == 0) && (it->chunkZ == 0) && (cx == 0) && (cz == 0) ) {
+          color = htobe32(0xeb3333);
+        } else {
+          color = htobe32(0xc1ffc4);
+        }
+      }
+
+      return color;
+    }
+
+    // make several images in one sweep over the chunks -- each chunk is looked up once per strip and then we fill
+    // the rows of every image from it
+    int32_t generateImages(const std::vector<ImageRequest>& requests) {
       const int32_t chunkOffsetX = -minChunkX;
       const int32_t chunkOffsetZ = -minChunkZ;
         
@@ -2497,193 +3465,106 @@ namespace mcpe_viz {
       const int32_t imageW = chunkW * 16;
       const int32_t imageH = chunkH * 16;
 
-      int32_t bpp = 3;
-      bool rgbaFlag = false;
-      uint8_t lut[256];
-      
-      if ( imageMode == kImageModeHeightColAlpha ) {
-        bpp = 4;
-        rgbaFlag = true;
-        // todobig - experiment with other ways to do this lut for height alpha
-        double vmax = (double)MAX_BLOCK_HEIGHT * (double)MAX_BLOCK_HEIGHT;
-        for (int32_t i=0; i <= MAX_BLOCK_HEIGHT; i++) {
-          // todobig make the offset (32) a cmdline param
-          double ti = ((MAX_BLOCK_HEIGHT+1) + 32) - i;
-          double v = ((double)(ti * ti) / vmax) * 255.0;
-          if ( v > 235.0 ) { v = 235.0; }
-          if ( v < 0.0 ) { v = 0.0; }
-          lut[i] = v;
-        }
-      }
+      // note: this is local because the images may be made at the same time (--threads)
+      int32_t colorSetNeedCount[512];
+      memset(colorSetNeedCount, 0, sizeof(colorSetNeedCount));
+      bool terrainFlag = false;
 
       // todohere -- reddit user silvergoat77 has a 1gb (!) world and it is approx 33k x 26k -- alloc chokes on this.
       // the solution is to write a chunk of rows at a time instead of the whole image...
       // but -- the code below is optimized to just iterate through the list and do it's thing instead of searching for each chunk
       // so --- we need to test before / after changing this to step thru in Z/X order
-      
-      // note RGB pixels
-      uint8_t *buf = new uint8_t[ imageW * 16 * bpp ];
 
-      uint8_t *rows[16];
-      for (int i=0; i < 16; i++) {
-        rows[i] = &buf[ i * imageW * bpp ];
-      }
+      std::vector< std::unique_ptr<ImageOutput> > outList;
+      for ( const auto& req : requests ) {
+        std::unique_ptr<ImageOutput> out(new ImageOutput());
+        out->imageMode = req.imageMode;
+        out->bpp = 3;
+        bool rgbaFlag = false;
+        if ( req.imageMode == kImageModeHeightColAlpha ) {
+          out->bpp = 4;
+          rgbaFlag = true;
+          // todobig - experiment with other ways to do this lut for height alpha
+          double vmax = (double)MAX_BLOCK_HEIGHT * (double)MAX_BLOCK_HEIGHT;
+          for (int32_t i=0; i <= MAX_BLOCK_HEIGHT; i++) {
+            // todobig make the offset (32) a cmdline param
+            double ti = ((MAX_BLOCK_HEIGHT+1) + 32) - i;
+            double v = ((double)(ti * ti) / vmax) * 255.0;
+            if ( v > 235.0 ) { v = 235.0; }
+            if ( v < 0.0 ) { v = 0.0; }
+            out->lut[i] = v;
+          }
+        }
+        if ( req.imageMode == kImageModeTerrain ) {
+          terrainFlag = true;
+        }
+        
+        // note RGB pixels
+        out->buf.resize( imageW * 16 * out->bpp );
+        for (int i=0; i < 16; i++) {
+          out->rows[i] = &out->buf[ i * imageW * out->bpp ];
+        }
 
-      int32_t color;
-      const char *pcolor;
-      if ( bpp == 4 ) {
-        pcolor = (const char*)&color;
-      } else {
-        const char* pcolor_temp = (const char*)&color;
-        pcolor = &pcolor_temp[1];
+        out->okFlag = ( outputPNG_init(out->png, req.fname, makeImageDescription(req.imageMode,0), imageW, imageH, rgbaFlag,
+                                       req.needFullImageFlag) == 0 );
+        if ( out->okFlag ) {
+          outList.push_back(std::move(out));
+        }
       }
-
-      PngWriter png;
-      if ( outputPNG_init(png, fname, makeImageDescription(imageMode,0), imageW, imageH, rgbaFlag) != 0 ) {
-        delete [] buf;
+      if ( outList.size() <= 0 ) {
         return -1;
       }
+      
+      int32_t ret = 0;
+      int32_t color;
+      const char *pcolor = (const char*)&color;
 
       for (int32_t iz=0, chunkZ=minChunkZ; iz < imageH; iz+=16, chunkZ++) {
 
-        // clear buffer
-        memset(buf, 0, imageW * 16 * bpp);
+        // clear buffers
+        for ( auto& out : outList ) {
+          memset(&out->buf[0], 0, out->buf.size());
+        }
         
         for (int32_t ix=0, chunkX=minChunkX; ix < imageW; ix+=16, chunkX++) {
 
-          ChunkKey chunkKey(chunkX, chunkZ);
-          if ( ! chunks_has_key(chunks, chunkKey) ) {
+          const ChunkData_LevelDB* it = chunkGrid.get(chunkX, chunkZ);
+          if ( it == nullptr ) {
             continue;
           }
-
-          const auto& it = chunks.at(chunkKey);
           
           int32_t imageX = (it->chunkX + chunkOffsetX) * 16;
           int32_t imageZ = (it->chunkZ + chunkOffsetZ) * 16;
 
           int32_t worldX = it->chunkX * 16;
           int32_t worldZ = it->chunkZ * 16;
-          
-          for (int32_t cz=0; cz < 16; cz++) {
-            for (int32_t cx=0; cx < 16; cx++) {
-
-              // todobig - we could do EVERYTHING (but initial key scan) in one pass:
-              //   do images here, then iterate over chunkspace again looking for items that populate geojson list
-              
-              // todo - this big conditional inside an inner loop, not so good
-
-              if ( imageMode == kImageModeBiome ) {
-                // get biome color
-                int32_t biomeId = it->grassAndBiome[cx][cz] & 0xff;
-                if ( has_key(biomeInfoList, biomeId) ) {
-                  color = biomeInfoList[biomeId]->color;
-                } else {
-                  slogger.msg(kLogInfo1,"ERROR: Unknown biome %d 0x%x\n", biomeId, biomeId);
-                  color = htobe32(0xff2020);
-                }
-              }
-              else if ( imageMode == kImageModeGrass ) {
-                // get grass color
-                int32_t grassColor = it->grassAndBiome[cx][cz] >> 8;
-                color = htobe32(grassColor);
-              }
-              else if ( imageMode == kImageModeHeightCol ) {
-                // get height value and use red-black-green palette
-                if ( control.heightMode == kHeightModeTop ) {
-                  uint8_t c = it->topBlockY[cx][cz];
-                  color = palRedBlackGreen[c];
-                } else {
-                  uint8_t c = it->heightCol[cx][cz];
-                  color = palRedBlackGreen[c];
-                }
-              }
-              else if ( imageMode == kImageModeHeightColGrayscale ) {
-                // get height value and make it grayscale
-                if ( control.heightMode == kHeightModeTop ) {
-                  uint8_t c = it->topBlockY[cx][cz];
-                  color = (c << 24) | (c << 16) | (c << 8);
-                } else {
-                  uint8_t c = it->heightCol[cx][cz];
-                  color = (c << 24) | (c << 16) | (c << 8);
-                }
-              }
-              else if ( imageMode == kImageModeHeightColAlpha ) {
-                // get height value and make it alpha
-                uint8_t c;
-                if ( control.heightMode == kHeightModeTop ) {
-                  c = it->topBlockY[cx][cz];
-                } else {
-                  c = it->heightCol[cx][cz];
-                }
-                // c = (90 - (int32_t)it->heightCol[cx][cz]) * 2;
-                c = lut[c];
-                color = ((c & 0xff) << 24);
-              }
-              else if ( imageMode == kImageModeBlockLight ) {
-                // get block light value and expand it (is only 4-bits)
-                uint8_t c = (it->topLight[cx][cz] & 0x0f) << 4;
-                color = (c << 24) | (c << 16) | (c << 8);
-              }
-              else if ( imageMode == kImageModeSkyLight ) {
-                // get sky light value and expand it (is only 4-bits)
-                uint8_t c = (it->topLight[cx][cz] & 0xf0);
-                color = (c << 24) | (c << 16) | (c << 8);
-              }
-              else {
-                // regular image
-                int32_t blockid = it->blocks[cx][cz];
-                
-                if ( blockInfoList[blockid].hasVariants() ) {
-                  // we need to get blockdata
-                  int32_t blockdata = it->data[cx][cz];
-                  bool vfound = false;
-                  for (const auto& itbv : blockInfoList[blockid].variantList) {
-                    if ( itbv->blockdata == blockdata ) {
-                      vfound = true;
-                      color = itbv->color;
-                      break;
-                    }
-                  }
-                  if ( ! vfound ) {
-                    // todo - warn once per id/blockdata or the output volume could get ridiculous
-                    slogger.msg(kLogInfo1,"WARNING: Did not find block variant for block (id=%d (0x%x) '%s') with blockdata=%d (0x%x) MSG1\n"
-                                , blockid, blockid
-                                , blockInfoList[blockid].name.c_str()
-                                , blockdata
-                                , blockdata
-                                );
-                    // since we did not find the variant, use the parent block's color
-                    color = blockInfoList[blockid].color;
-                  }
-                } else {
-                  color = blockInfoList[blockid].color;
-                  if ( ! blockInfoList[blockid].colorSetFlag ) {
-                    blockInfoList[blockid].colorSetNeedCount++;
-                  }
-                }
-              }
-
-              // do grid lines
-              if ( checkDoForDim(control.doGrid) && (cx==0 || cz==0) ) {
-                if ( (it->chunkX == 0) && (it->chunkZ == 0) && (cx == 0) && (cz == 0) ) {
-                  color = htobe32(0xeb3333);
-                } else {
-                  color = htobe32(0xc1ffc4);
-                }
-              }
 
+          for ( auto& out : outList ) {
+            const int32_t bpp = out->bpp;
+            // note: for RGB we skip the first byte of the color
+            const char *pc = ( bpp == 4 ) ? pcolor : &pcolor[1];
+            uint8_t *buf = &out->buf[0];
+            
+            for (int32_t cz=0; cz < 16; cz++) {
+              for (int32_t cx=0; cx < 16; cx++) {
+                color = getImagePixelColor(it, cx, cz, *out, colorSetNeedCount);
 #ifdef PIXEL_COPY_MEMCPY
-              memcpy(&buf[ ((cz) * imageW + (imageX + cx)) * bpp], pcolor, bpp);
+                memcpy(&buf[ ((cz) * imageW + (imageX + cx)) * bpp], pc, bpp);
 #else
-              // todobig - support for bpp here
-              // todo - any use in optimizing the offset calc?
-              buf[((cz) * imageW + (imageX + cx)) * 3] = pcolor[1];
-              buf[((cz) * imageW + (imageX + cx)) * 3 + 1] = pcolor[2];
-              buf[((cz) * imageW + (imageX + cx)) * 3 + 2] = pcolor[3];
+                // todobig - support for bpp here
+                // todo - any use in optimizing the offset calc?
+                buf[((cz) * imageW + (imageX + cx)) * 3] = pcolor[1];
+                buf[((cz) * imageW + (imageX + cx)) * 3 + 1] = pcolor[2];
+                buf[((cz) * imageW + (imageX + cx)) * 3 + 2] = pcolor[3];
 #endif
+              }
+            }
+          }
 
-              // report interesting coordinates
-              if ( dimId == kDimIdOverworld && imageMode == kImageModeTerrain ) {
+          // report interesting coordinates
+          if ( dimId == kDimIdOverworld && terrainFlag ) {
+            for (int32_t cz=0; cz < 16; cz++) {
+              for (int32_t cx=0; cx < 16; cx++) {
                 int32_t tix = (imageX + cx);
                 int32_t tiz = (imageZ + cz);
                 int32_t twx = (worldX + cx);
@@ -2699,24 +3580,31 @@ namespace mcpe_viz {
             }
           }
         }
+        
         // write rows
-        outputPNG_writeRows(png, rows, 16);
+        for ( auto& out : outList ) {
+          if ( outputPNG_writeRows(out->png, out->rows, 16) != 0 ) {
+            ret = -1;
+          }
+        }
       }
         
-      // output the image
-      outputPNG_close(png);
-      
-      delete [] buf;
+      // output the images
+      for ( auto& out : outList ) {
+        if ( outputPNG_close(out->png) != 0 ) {
+          ret = -1;
+        }
+      }
       
       // report items that need to have their color set properly (in the XML file)
-      if ( imageMode == kImageModeTerrain ) {
+      if ( terrainFlag ) {
         for (int32_t i=0; i < 512; i++) {
-          if ( blockInfoList[i].colorSetNeedCount ) {
-            slogger.msg(kLogInfo1,"    Need pixel color for: 0x%x '%s' (%d)\n", i, blockInfoList[i].name.c_str(), blockInfoList[i].colorSetNeedCount);
+          if ( colorSetNeedCount[i] ) {
+            slogger.msg(kLogInfo1,"    Need pixel color for: 0x%x '%s' (%d)\n", i, blockInfoList[i].name.c_str(), colorSetNeedCount[i]);
           }
         }
       }
-      return 0;
+      return ret;
     }
     
 
@@ -2807,12 +3695,13 @@ namespace mcpe_viz {
         rows[i] = &buf[ i * imageW * bpp ];
       }
       
-      PngWriter png;
+      PngImageWriter png;
       if ( outputPNG_init(png, fname, makeImageDescription(imageMode,0), imageW, imageH, rgbaFlag) != 0 ) {
         delete [] buf;
         return -1;
       }
       
+      int32_t ret = 0;
       int32_t color;
       for (int32_t iz=0, chunkZ=minChunkZ; iz < imageH; iz+=16, chunkZ++) {
         memset(buf, 0, imageW*16*bpp);
@@ -2870,15 +3759,19 @@ namespace mcpe_viz {
             }
           }
         }
-        outputPNG_writeRows(png, rows, 16);
+        if ( outputPNG_writeRows(png, rows, 16) != 0 ) {
+          ret = -1;
+        }
       }
         
       // output the image
-      outputPNG_close(png);
+      if ( outputPNG_close(png) != 0 ) {
+        ret = -1;
+      }
 
       delete [] buf;
 
-      return 0;
+      return ret;
     }
     
     // originally from: http://openlayers.org/en/v3.10.0/examples/shaded-relief.html
@@ -2920,7 +3813,7 @@ namespace mcpe_viz {
       int32_t destH = srcH;
       uint8_t *buf = new uint8_t[ destW * bppDest ];
     
-      PngWriter pngOut;
+      PngImageWriter pngOut;
       if ( outputPNG_init(pngOut, fnDest, makeImageDescription(kImageModeShadedRelief,0), destW, destH, true) != 0 ) {
         delete [] buf;
         pngSrc.close();
@@ -2947,6 +3840,7 @@ namespace mcpe_viz {
 #define M_PI            3.14159265358979323846
 #endif
       
+      int32_t ret = 0;
       int32_t maxX = srcW - 1;
       int32_t maxY = srcH - 1;
       double twoPi = 2.0 * M_PI;
@@ -3095,11 +3989,15 @@ namespace mcpe_viz {
         }
 
         // output image data
-        outputPNG_writeRow(pngOut, buf);
+        if ( outputPNG_writeRow(pngOut, buf) != 0 ) {
+          ret = -1;
+        }
       
       }
 
-      outputPNG_close(pngOut);
+      if ( outputPNG_close(pngOut) != 0 ) {
+        ret = -1;
+      }
 
       delete [] buf;
 
@@ -3107,7 +4005,7 @@ namespace mcpe_viz {
 
       delete [] sbuf;
 
-      return 0;
+      return ret;
     }
     
 
@@ -3173,9 +4071,11 @@ namespace mcpe_viz {
       const char *pcolor = (const char*)&color;
 
       int16_t* emuchunk = new int16_t[NUM_BYTES_CHUNK_V3];
+      int32_t ret = 0;
       
       // create png helpers
-      PngWriter png[MAX_BLOCK_HEIGHT + 1];
+      PngImageWriter png[MAX_BLOCK_HEIGHT + 1];
+      std::vector< std::vector<uint8_t*> > rowPointers(MAX_BLOCK_HEIGHT + 1, std::vector<uint8_t*>(16));
       for (int32_t cy=0; cy <= MAX_BLOCK_HEIGHT; cy++) {
         std::string fnameTmp = fnBase + ".mcpe_viz_slice.full.";
         fnameTmp += name;
@@ -3186,7 +4086,8 @@ namespace mcpe_viz {
 
         control.fnLayerRaw[dimId][cy] = fnameTmp;
           
-        if ( png[cy].init(fnameTmp, makeImageDescription(-1,cy), imageW, imageH, 16, false, true) != 0 ) {
+        // note: we do not write the slices straight to tiles -- a tile pyramid for each of the slices would be open at once
+        if ( outputPNG_init(png[cy], fnameTmp, makeImageDescription(-1,cy), imageW, imageH, false, true, false) != 0 ) {
           delete[] emuchunk;
           return -1;
         }
@@ -3198,7 +4099,7 @@ namespace mcpe_viz {
         rbuf[cy] = new uint8_t[(imageW*3)*16];
         // setup row pointers
         for (int32_t cz=0; cz<16; cz++) {
-          png[cy].row_pointers[cz] = &rbuf[cy][(cz*imageW)*3];
+          rowPointers[cy][cz] = &rbuf[cy][(cz*imageW)*3];
         }
       }
 
@@ -3532,13 +4433,17 @@ namespace mcpe_viz {
         // put the png rows
         // todo - png lib is SLOW - worth it to alloc a larger window (16-row increments) and write in batches?
         for (int32_t cy=0; cy <= MAX_BLOCK_HEIGHT; cy++) {
-          png_write_rows(png[cy].png, png[cy].row_pointers, 16);
+          if ( outputPNG_writeRows(png[cy], &rowPointers[cy][0], 16) != 0 ) {
+            ret = -1;
+          }
         }
       }
         
       for (int32_t cy=0; cy <= MAX_BLOCK_HEIGHT; cy++) {
         delete [] rbuf[cy];
-        png[cy].close();
+        if ( outputPNG_close(png[cy]) != 0 ) {
+          ret = -1;
+        }
       }
 
       delete [] tbuf;
@@ -3546,7 +4451,7 @@ namespace mcpe_viz {
       // slogger.msg(kLogInfo1,"    Chunk Info: Found = %d / Not Found (our list) = %d / Not Found (leveldb) = %d\n", foundCt, notFoundCt1, notFoundCt2);
         
       delete[] emuchunk;
-      return 0;
+      return ret;
     }
 
       
@@ -3652,7 +4557,7 @@ namespace mcpe_viz {
                     
                   if ( blockInfoList[blockid].hasVariants() ) {
                     // we need to get blockdata
-                    int32_t blockdata = it.second->data[cx][cz];
+                    int32_t blockdata = it.second->getBlockData(cx,cz);
                     bool vfound = false;
                     for (const auto& itbv : blockInfoList[blockid].variantList) {
                       if ( itbv->blockdata == blockdata ) {
@@ -3767,7 +4672,7 @@ namespace mcpe_viz {
           + makeGeojsonHeader(ix,iy)
           + tmpstring
           ;
-        listGeoJSON.push_back( json );
+        geojsonSink.add( json );
       }
     
       return 0;
@@ -3877,97 +4782,151 @@ namespace mcpe_viz {
     }
 
     
-    int32_t doOutput(leveldb::DB* db) {
-      slogger.msg(kLogInfo1,"Do Output: %s\n",name.c_str());
-        
-      doOutputStats();
-
-      doOutput_GeoJSON();
+    // note: the images only read the chunks, so they can be made at the same time (see OutputTaskList)
+    // serial groups: kOutputGroupStart is used for the work that touches global state, kOutputGroupFinish for the db work
+    int32_t addOutputTasks(leveldb::DB* db, OutputTaskList& tasks) {
+      // note: the chunks do not change after this
+      chunkGrid.build(chunks, minChunkX, minChunkZ, maxChunkX, maxChunkZ);
+      
+      tasks.add([this]() {
+          slogger.msg(kLogInfo1,"Do Output: %s\n",name.c_str());
+          doOutputStats();
+          doOutput_GeoJSON();
+        }, std::vector<size_t>(), kOutputGroupStart);
       
       // we put images in subdir
       std::string fnBase = mybasename(control.fnOutputBase);
       std::string dirOut = mydirname(control.fnOutputBase) + "/images";
       local_mkdir(dirOut.c_str());
-      
-      slogger.msg(kLogInfo1,"  Generate Image\n");
+
+      // the chunk images are made in one sweep over the chunks (see generateImages)
+      // note: with --threads we split them up into several sweeps so that we can do them at the same time
+      std::vector< std::pair<std::string, ImageRequest> > requests;
+
       control.fnLayerTop[dimId] = std::string(dirOut + "/" + fnBase + "." + name + ".map.png");
-      generateImage(control.fnLayerTop[dimId], kImageModeTerrain);
+      requests.push_back( std::make_pair("  Generate Image\n", ImageRequest(control.fnLayerTop[dimId], kImageModeTerrain, false)) );
         
       if ( checkDoForDim(control.doImageBiome) ) {
-        slogger.msg(kLogInfo1,"  Generate Biome Image\n");
         control.fnLayerBiome[dimId] = std::string(dirOut + "/" + fnBase + "." + name + ".biome.png");
-        generateImage(control.fnLayerBiome[dimId], kImageModeBiome);
+        requests.push_back( std::make_pair("  Generate Biome Image\n", ImageRequest(control.fnLayerBiome[dimId], kImageModeBiome, false)) );
       }
       if ( checkDoForDim(control.doImageGrass) ) {
-        slogger.msg(kLogInfo1,"  Generate Grass Image\n");
         control.fnLayerGrass[dimId] = std::string(dirOut + "/" + fnBase + "." + name + ".grass.png");
-        generateImage(control.fnLayerGrass[dimId], kImageModeGrass);
+        requests.push_back( std::make_pair("  Generate Grass Image\n", ImageRequest(control.fnLayerGrass[dimId], kImageModeGrass, false)) );
       }
       if ( checkDoForDim(control.doImageHeightCol) ) {
-        slogger.msg(kLogInfo1,"  Generate Height Column Image\n");
         control.fnLayerHeight[dimId] = std::string(dirOut + "/" + fnBase + "." + name + ".height_col.png");
-        generateImage(control.fnLayerHeight[dimId], kImageModeHeightCol);
+        requests.push_back( std::make_pair("  Generate Height Column Image\n",
+                                           ImageRequest(control.fnLayerHeight[dimId], kImageModeHeightCol, false)) );
       }
       if ( checkDoForDim(control.doImageHeightColGrayscale) ) {
-        slogger.msg(kLogInfo1,"  Generate Height Column (grayscale) Image\n");
         control.fnLayerHeightGrayscale[dimId] = std::string(dirOut + "/" + fnBase + "." + name + ".height_col_grayscale.png");
-        generateImage(control.fnLayerHeightGrayscale[dimId], kImageModeHeightColGrayscale);
+        // note: the shaded relief image is made from this image
+        requests.push_back( std::make_pair("  Generate Height Column (grayscale) Image\n",
+                                           ImageRequest(control.fnLayerHeightGrayscale[dimId], kImageModeHeightColGrayscale,
+                                                        checkDoForDim(control.doImageShadedRelief))) );
       }
       if ( checkDoForDim(control.doImageHeightColAlpha) ) {
-        slogger.msg(kLogInfo1,"  Generate Height Column (alpha) Image\n");
         control.fnLayerHeightAlpha[dimId] = std::string(dirOut + "/" + fnBase + "." + name + ".height_col_alpha.png");
-        generateImage(control.fnLayerHeightAlpha[dimId], kImageModeHeightColAlpha);
+        requests.push_back( std::make_pair("  Generate Height Column (alpha) Image\n",
+                                           ImageRequest(control.fnLayerHeightAlpha[dimId], kImageModeHeightColAlpha, false)) );
       }
       if ( checkDoForDim(control.doImageLightBlock) ) {
-        slogger.msg(kLogInfo1,"  Generate Block Light Image\n");
         control.fnLayerBlockLight[dimId] = std::string(dirOut + "/" + fnBase + "." + name + ".light_block.png");
-        generateImage(control.fnLayerBlockLight[dimId], kImageModeBlockLight);
+        requests.push_back( std::make_pair("  Generate Block Light Image\n",
+                                           ImageRequest(control.fnLayerBlockLight[dimId], kImageModeBlockLight, false)) );
       }
       if ( checkDoForDim(control.doImageLightSky) ) {
-        slogger.msg(kLogInfo1,"  Generate Sky Light Image\n");
         control.fnLayerSkyLight[dimId] = std::string(dirOut + "/" + fnBase + "." + name + ".light_sky.png");
-        generateImage(control.fnLayerSkyLight[dimId], kImageModeSkyLight);
+        requests.push_back( std::make_pair("  Generate Sky Light Image\n",
+                                           ImageRequest(control.fnLayerSkyLight[dimId], kImageModeSkyLight, false)) );
+      }
+
+      std::vector<size_t> imageTasks;
+      size_t grayscaleTask = 0;
+      bool grayscaleTaskFlag = false;
+      
+      const size_t sweepCt = std::min(requests.size(), (size_t)std::max(1, control.threadCount));
+      for (size_t i=0; i < sweepCt; i++) {
+        std::vector< std::pair<std::string, ImageRequest> > sweep;
+        bool grayscaleFlag = false;
+        for (size_t j=i; j < requests.size(); j += sweepCt) {
+          sweep.push_back(requests[j]);
+          if ( requests[j].second.imageMode == kImageModeHeightColGrayscale ) {
+            grayscaleFlag = true;
+          }
+        }
+        size_t task = tasks.add([this,sweep]() {
+            std::vector<ImageRequest> sweepRequests;
+            for ( const auto& it : sweep ) {
+              slogger.msg(kLogInfo1, "%s", it.first.c_str());
+              sweepRequests.push_back(it.second);
+            }
+            if ( generateImages(sweepRequests) != 0 ) {
+              slogger.msg(kLogInfo1,"ERROR: Failed to write some of the images for %s\n", name.c_str());
+            }
+          });
+        imageTasks.push_back(task);
+        if ( grayscaleFlag ) {
+          grayscaleTask = task;
+          grayscaleTaskFlag = true;
+        }
       }
+      
       if ( checkDoForDim(control.doImageSlimeChunks) ) {
-        slogger.msg(kLogInfo1,"  Generate Slime Chunks Image\n");
         control.fnLayerSlimeChunks[dimId] = std::string(dirOut + "/" + fnBase + "." + name + ".slime_chunks.png");
-        generateImageSpecial(control.fnLayerSlimeChunks[dimId], kImageModeSlimeChunksMCPE);
+        imageTasks.push_back(tasks.add([this]() {
+              slogger.msg(kLogInfo1,"  Generate Slime Chunks Image\n");
+              if ( generateImageSpecial(control.fnLayerSlimeChunks[dimId], kImageModeSlimeChunksMCPE) != 0 ) {
+                slogger.msg(kLogInfo1,"ERROR: Failed to write the slime chunks image for %s\n", name.c_str());
+              }
+            }));
       }
 
       if ( checkDoForDim(control.doImageShadedRelief) ) {
-        slogger.msg(kLogInfo1,"  Generate Shaded Relief Image\n");
         control.fnLayerShadedRelief[dimId] = std::string(dirOut + "/" + fnBase + "." + name + ".shaded_relief.png");
 
-        if ( false ) {
-          // todobig - idea is to oversample the src image and then get higher resolution shaded relief - but, openlayers does not cooperate with this idea :) -- could fiddle with it later
-          // todo - param for oversample
-          std::string fnTemp = std::string(dirOut + "/" + fnBase + "." + name + ".shaded_relief.temp.png");
-          if ( oversampleImage(control.fnLayerHeightGrayscale[dimId], fnTemp, 2) == 0 ) {
-            generateShadedRelief(fnTemp, control.fnLayerShadedRelief[dimId]);
-            // remove temporary file
-            deleteFile(fnTemp);
-          }
-        } else {
-          generateShadedRelief(control.fnLayerHeightGrayscale[dimId], control.fnLayerShadedRelief[dimId]);
-        }
+        // note: we need the grayscale image first
+        std::vector<size_t> waitFor;
+        if ( grayscaleTaskFlag ) {
+          waitFor.push_back(grayscaleTask);
+        }
+        imageTasks.push_back(tasks.add([this,dirOut,fnBase]() {
+              slogger.msg(kLogInfo1,"  Generate Shaded Relief Image\n");
+
+              if ( false ) {
+                // todobig - idea is to oversample the src image and then get higher resolution shaded relief - but, openlayers does not cooperate with this idea :) -- could fiddle with it later
+                // todo - param for oversample
+                std::string fnTemp = std::string(dirOut + "/" + fnBase + "." + name + ".shaded_relief.temp.png");
+                if ( oversampleImage(control.fnLayerHeightGrayscale[dimId], fnTemp, 2) == 0 ) {
+                  generateShadedRelief(fnTemp, control.fnLayerShadedRelief[dimId]);
+                  // remove temporary file
+                  deleteFile(fnTemp);
+                }
+              } else {
+                if ( generateShadedRelief(control.fnLayerHeightGrayscale[dimId], control.fnLayerShadedRelief[dimId]) != 0 ) {
+                  slogger.msg(kLogInfo1,"ERROR: Failed to write the shaded relief image for %s\n", name.c_str());
+                }
+              }
+            }, waitFor, -1));
       }
 
-      if ( checkDoForDim(control.doMovie) ) {
-        slogger.msg(kLogInfo1,"  Generate movie\n");
-        generateMovie(db, dirOut + "/" + fnBase, std::string(control.fnOutputBase + "." + name + ".mp4"), true, true);
-      }
+      // todo - movie and slices could be done at the same time as the images too
+      tasks.add([this,db,dirOut,fnBase]() {
+          if ( checkDoForDim(control.doMovie) ) {
+            slogger.msg(kLogInfo1,"  Generate movie\n");
+            generateMovie(db, dirOut + "/" + fnBase, std::string(control.fnOutputBase + "." + name + ".mp4"), true, true);
+          }
 
-      if ( checkDoForDim(control.doSlices) ) {
-        slogger.msg(kLogInfo1,"  Generate full-size slices\n");
-        generateSlices(db, dirOut + "/" + fnBase);
-      }
+          if ( checkDoForDim(control.doSlices) ) {
+            slogger.msg(kLogInfo1,"  Generate full-size slices\n");
+            if ( generateSlices(db, dirOut + "/" + fnBase) != 0 ) {
+              slogger.msg(kLogInfo1,"ERROR: Failed to write the slices for %s\n", name.c_str());
+            }
+          }
 
-      doOutput_Schematic(db);
-    
-      // reset
-      for (int32_t i=0; i < 512; i++) {
-        blockInfoList[i].colorSetNeedCount = 0;
-      }
+          doOutput_Schematic(db);
+        }, imageTasks, kOutputGroupFinish);
 
       return 0;
     }
@@ -3977,8 +4936,10 @@ namespace mcpe_viz {
   
   // todobig - move to util?
   int32_t printKeyValue(const char* key, int32_t key_size, const char* value, int32_t value_size, bool printKeyAsStringFlag) {
+    // note: key is not null-terminated
+    std::string keyString(key, key_size);
     logger.msg(kLogInfo1,"WARNING: Unparsed Record: key_size=%d key_string=[%s] key_hex=[", key_size, 
-               (printKeyAsStringFlag ? key : "(SKIPPED)"));
+               (printKeyAsStringFlag ? keyString.c_str() : "(SKIPPED)"));
     for (int32_t i=0; i < key_size; i++) {
       if ( i > 0 ) { logger.msg(kLogInfo1," "); }
       logger.msg(kLogInfo1,"%02x",((int)key[i] & 0xff));
@@ -4002,126 +4963,861 @@ namespace mcpe_viz {
   }
     
 
+  // parse the key of a chunk record (key_size must be 9, 10, 13 or 14)
+  // returns -1 if the chunk is in a dimension that we do not know about
+  int32_t parseChunkKey ( const char* key, size_t key_size,
+                          int32_t& chunkX, int32_t& chunkZ, int32_t& chunkDimId, int32_t& chunkType, int32_t& chunkTypeSub,
+                          int32_t& chunkFormatVersion, std::string& dimName ) {
+    chunkTypeSub = 0;
+          
+    if ( key_size == 9 ) {
+      // overworld chunk
+      chunkX = myParseInt32(key, 0);
+      chunkZ = myParseInt32(key, 4);
+      chunkDimId = kDimIdOverworld;
+      chunkType = myParseInt8(key, 8);
+      dimName = "overworld";
+      chunkFormatVersion = 2; //todonow - get properly
+    }
+    else if ( key_size == 10 ) {
+      // overworld chunk
+      chunkX = myParseInt32(key, 0);
+      chunkZ = myParseInt32(key, 4);
+      chunkDimId = kDimIdOverworld;
+      chunkType = myParseInt8(key, 8);
+      chunkTypeSub = myParseInt8(key, 9); // todonow - rename
+      dimName = "overworld";
+      chunkFormatVersion = 3; //todonow - get properly
+    }
+    else if ( key_size == 13 || key_size == 14 ) {
+      // non-overworld chunk
+      chunkX = myParseInt32(key, 0);
+      chunkZ = myParseInt32(key, 4);
+      chunkDimId = myParseInt32(key, 8);
+      chunkType = myParseInt8(key, 12);
+      dimName = "nether";
+      if ( key_size == 13 ) {
+        chunkFormatVersion = 2; //todonow - get properly
+      } else {
+        chunkTypeSub = myParseInt8(key, 13); // todonow - rename
+        chunkFormatVersion = 3; //todonow - get properly
+      }
 
-  // base class for a minecraft world
-  class MinecraftWorld {
-  private:
-    std::string worldName;
-    int64_t worldSeed;
-    int32_t worldSpawnX;
-    int32_t worldSpawnY;
-    int32_t worldSpawnZ;
-
-  public:
-    MinecraftWorld() {
-      worldName = "UNKNOWN-NOT-SET";
-      worldSeed = 0;
-      worldSpawnX = 0;
-      worldSpawnY = 0;
-      worldSpawnZ = 0;
+      // adjust weird dim id's
+      if ( chunkDimId == 0x32373639 ) {
+        chunkDimId = kDimIdTheEnd;
+      }
+      if ( chunkDimId == 0x33373639 ) {
+        chunkDimId = kDimIdNether;
+      }
+      
+      // check for new dim id's
+      if ( chunkDimId != kDimIdNether && chunkDimId != kDimIdTheEnd ) {
+        return -1;
+      }
     }
+    return 0;
+  }
 
-    void setWorldName(const std::string& s) { worldName = s; }
-    const std::string& getWorldName() const { return worldName; }
+  // these are the records that dbParseRecord identifies by name
+  // note: keep this in sync with dbParseRecord -- the dbParse worker threads use it to skip non-chunk records
+  bool isNamedRecordKey ( const char* key, size_t key_size ) {
+    static const char* names[] = {
+      "BiomeData", "Overworld", "~local_player", "villages", "mVillages", "game_flatworldlayers",
+      "idcounts", "Nether", "portals", "AutonomousEntities"
+    };
+    for ( const auto& it : names ) {
+      if ( strncmp(key, it, key_size) == 0 ) {
+        return true;
+      }
+    }
+    if ( (key_size>=7) && (strncmp(key,"player_",7) == 0) ) {
+      return true;
+    }
+    if ( strncmp(key,"dimension",9) == 0 ) {
+      return true;
+    }
+    return false;
+  }
 
-    void setWorldSeed(int64_t s) { worldSeed = s; }
-    int64_t getWorldSeed() const { return worldSeed; }
+  // is this a terrain record (0x30, 0x2f or 0x2d) for a legal chunk? these are the records that are decoded into chunks
+  bool parseTerrainKey ( const char* key, size_t key_size,
+                         int32_t& chunkX, int32_t& chunkZ, int32_t& chunkDimId, int32_t& chunkType, int32_t& chunkTypeSub,
+                         int32_t& chunkFormatVersion ) {
+    std::string dimName;
+    if ( !(key_size == 9 || key_size == 10 || key_size == 13 || key_size == 14) ) {
+      return false;
+    }
+    if ( isNamedRecordKey(key, key_size) ) {
+      return false;
+    }
+    if ( parseChunkKey(key, key_size, chunkX, chunkZ, chunkDimId, chunkType, chunkTypeSub, chunkFormatVersion, dimName) != 0 ) {
+      return false;
+    }
+    if ( ! legalChunkPos(chunkX,chunkZ) ) {
+      return false;
+    }
+    return ( chunkType == 0x30 || chunkType == 0x2f || chunkType == 0x2d );
+  }
 
-    void setWorldSpawnX(int32_t v) { worldSpawnX = v; }
-    int32_t getWorldSpawnX() const { return worldSpawnX; }
-    void setWorldSpawnY(int32_t v) { worldSpawnY = v; }
-    int32_t getWorldSpawnY() const { return worldSpawnY; }
-    void setWorldSpawnZ(int32_t v) { worldSpawnZ = v; }
-    int32_t getWorldSpawnZ() const { return worldSpawnZ; }
-  };
+  // as above, but we only want to know which chunk column the record belongs to
+  bool parseTerrainKey ( const std::string& key, int32_t& chunkDimId, int32_t& chunkX, int32_t& chunkZ ) {
+    int32_t chunkType, chunkTypeSub, chunkFormatVersion;
+    return parseTerrainKey(key.data(), key.size(), chunkX, chunkZ, chunkDimId, chunkType, chunkTypeSub, chunkFormatVersion);
+  }
+  
 
+  // iterate over a range of keys -- an empty keyStart is the first key, an empty keyEnd is past the last key
+  inline void iterSeek ( leveldb::Iterator* iter, const std::string& keyStart ) {
+    if ( keyStart.size() == 0 ) {
+      iter->SeekToFirst();
+    } else {
+      iter->Seek(keyStart);
+    }
+  }
 
-  class MinecraftWorld_LevelDB : public MinecraftWorld {
-  private:
-    leveldb::DB* db;
-    std::unique_ptr<leveldb::Options> dbOptions;
-    int32_t totalRecordCt;
+  inline bool iterInRange ( leveldb::Iterator* iter, const std::string& keyEnd ) {
+    if ( ! iter->Valid() ) {
+      return false;
+    }
+    if ( keyEnd.size() == 0 ) {
+      return true;
+    }
+    return iter->key().compare(leveldb::Slice(keyEnd)) < 0;
+  }
   
+
+  // chunk bounds found by scanning a range of keys (calcChunkBounds uses one of these per thread)
+  class ChunkBoundsScan {
   public:
-    // todobig - move to private?
-    std::unique_ptr<DimensionData_LevelDB> dimDataList[kDimIdCount];
+    int32_t recordCt;
+    // note: like DimensionData_LevelDB, the bounds always include chunk 0,0
+    int32_t minChunkX[kDimIdCount], maxChunkX[kDimIdCount];
+    int32_t minChunkZ[kDimIdCount], maxChunkZ[kDimIdCount];
+    bool statusOk;
+    std::string statusString;
+
+    ChunkBoundsScan() {
+      recordCt = 0;
+      memset(minChunkX, 0, sizeof(minChunkX));
+      memset(maxChunkX, 0, sizeof(maxChunkX));
+      memset(minChunkZ, 0, sizeof(minChunkZ));
+      memset(maxChunkZ, 0, sizeof(maxChunkZ));
+      statusOk = true;
+      statusString = "";
+    }
 
-    MinecraftWorld_LevelDB() {
-      db = nullptr;
-      
-      levelDbReadOptions.fill_cache = false;
-      // suggestion from leveldb/mcpe_sample_setup.cpp
-      levelDbReadOptions.decompress_allocator = new leveldb::DecompressAllocator();
+    void add(int32_t dimId, int32_t chunkX, int32_t chunkZ) {
+      if ( dimId < 0 || dimId >= kDimIdCount ) {
+        return;
+      }
+      minChunkX[dimId] = std::min(minChunkX[dimId], chunkX);
+      maxChunkX[dimId] = std::max(maxChunkX[dimId], chunkX);
+      minChunkZ[dimId] = std::min(minChunkZ[dimId], chunkZ);
+      maxChunkZ[dimId] = std::max(maxChunkZ[dimId], chunkZ);
+    }
+  };
+  
 
+  // --chunk-cache: what dbParse got from the terrain records of one chunk column
+  class ChunkCacheEntry {
+  public:
+    // hash of the keys and values of the terrain records
+    uint64_t hash;
+    // note: this is the same chunk object that the dimension has -- chunks are not changed after they are decoded
+    std::shared_ptr<ChunkData_LevelDB> chunk;
+    // note: these are sparse because we keep an entry for every chunk column
+    HistogramVector histogramBlock;
+    HistogramVector histogramBiome;
+    // where the geojson items are in the chunk cache geojson file that this entry was read from (or written to)
+    // note: we don't keep them in memory; they have world coords (see makeGeojsonHeaderWorld)
+    uint64_t geojsonOffset;
+    uint32_t geojsonSize;
+    uint32_t geojsonCount;
+
+    ChunkCacheEntry() {
+      hash = 0;
+      geojsonOffset = 0;
+      geojsonSize = 0;
+      geojsonCount = 0;
+    }
+  };
 
-      dbOptions = std::unique_ptr<leveldb::Options>(new leveldb::Options);
-      //dbOptions->compressors[0] = new leveldb::ZlibCompressor();
-      dbOptions->create_if_missing = false;
+  // dimId, chunkX, chunkZ
+  typedef std::tuple<int32_t, int32_t, int32_t> ChunkCacheKey;
+  typedef std::map< ChunkCacheKey, std::shared_ptr<const ChunkCacheEntry> > ChunkCacheMap;
+  typedef std::vector< std::pair< ChunkCacheKey, std::shared_ptr<const ChunkCacheEntry> > > ChunkCacheList;
+
+  // --chunk-cache: the decoded chunk columns are saved next to the output files so that the next run
+  // only needs to decode the chunk columns that have changed
+  // note: the file is in host byte order; it is ignored if it is from a host with the other byte order, or if the mcpe_viz
+  //   version or the decode settings change
+  // note: the geojson items are in a second file (fn.geojson) that is read and written as the chunk columns are handled
+  class ChunkCache {
+  private:
+    // from the cache file -- read-only while dbParse is running (the worker threads use it)
+    ChunkCacheMap prevEntries;
+    // for the new cache file
+    ChunkCacheMap entries;
+    uint64_t settingsHash;
+
+    // we also keep what we need to know which image tiles changed since the last run
+    bool prevLoadedFlag;
+    uint64_t prevOutputHash, outputHash;
+    int32_t prevBounds[kDimIdCount][4], bounds[kDimIdCount][4];
+    std::set<ChunkCacheKey> changedKeys;
+
+    // the geojson file from the last run (read) and the one for this run (written to a temp file until save)
+    // note: the worker threads use these, so they have their own lock
+    std::mutex geojsonMtx;
+    FILE* prevGeojsonFp;
+    FILE* geojsonFp;
+    std::string fnGeojsonTemp;
+    uint64_t geojsonOffset;
+    bool geojsonOkFlag;
+    // the main file has the id of its geojson file so that we never use a main file with the wrong geojson file
+    uint64_t geojsonFileId;
+
+    // note: the fields are in host byte order -- the header has kByteOrderMark so that a file from a host with the
+    //   other byte order is not used
+    template <typename T>
+    static void put(FILE* fp, const T& v, bool& okFlag) {
+      if ( okFlag && fwrite(&v, sizeof(T), 1, fp) != 1 ) {
+        okFlag = false;
+      }
+    }
+    template <typename T>
+    static void get(FILE* fp, T& v, bool& okFlag) {
+      if ( okFlag && fread(&v, sizeof(T), 1, fp) != 1 ) {
+        okFlag = false;
+      }
+    }
+    static void putString(FILE* fp, const std::string& v, bool& okFlag) {
+      put(fp, (uint32_t)v.size(), okFlag);
+      if ( okFlag && v.size() > 0 && fwrite(v.data(), v.size(), 1, fp) != 1 ) {
+        okFlag = false;
+      }
+    }
+    static void getString(FILE* fp, std::string& v, bool& okFlag) {
+      uint32_t len = 0;
+      get(fp, len, okFlag);
+      // sanity check
+      if ( len > (1024 * 1024) ) {
+        okFlag = false;
+      }
+      if ( okFlag ) {
+        v.resize(len);
+        if ( len > 0 && fread(&v[0], len, 1, fp) != 1 ) {
+          okFlag = false;
+        }
+      }
+    }
+    static void putHistogram(FILE* fp, const HistogramVector& h, bool& okFlag) {
+      put(fp, (uint32_t)h.size(), okFlag);
+      for ( const auto& it : h ) {
+        put(fp, (int32_t)it.first, okFlag);
+        put(fp, (int32_t)it.second, okFlag);
+      }
+    }
+    static void getHistogram(FILE* fp, HistogramVector& h, bool& okFlag) {
+      uint32_t n = 0;
+      get(fp, n, okFlag);
+      if ( n > 512 ) {
+        okFlag = false;
+      }
+      for (uint32_t i=0; okFlag && i < n; i++) {
+        int32_t k = 0, v = 0;
+        get(fp, k, okFlag);
+        get(fp, v, okFlag);
+        h.push_back(HistogramItem(k, v));
+      }
+    }
 
-      // this filter is supposed to reduce disk reads - light testing indicates that it is faster when doing 'html-all'
-      if ( control.leveldbFilter > 0 ) {
-        dbOptions->filter_policy = leveldb::NewBloomFilterPolicy(control.leveldbFilter);
+    static void putEntry(FILE* fp, const ChunkCacheEntry& e, bool& okFlag) {
+      put(fp, e.hash, okFlag);
+      put(fp, (uint8_t)(e.chunk ? 1 : 0), okFlag);
+      if ( e.chunk ) {
+        const ChunkData_LevelDB& c = *e.chunk;
+        put(fp, c.topBlock, okFlag);
+        put(fp, c.biome, okFlag);
+        put(fp, (uint8_t)(c.grass ? 1 : 0), okFlag);
+        if ( c.grass ) {
+          okFlag = okFlag && ( fwrite(c.grass.get(), sizeof(uint32_t), 16 * 16, fp) == 16 * 16 );
+        }
+        put(fp, c.topBlockY, okFlag);
+        put(fp, c.heightCol, okFlag);
+        put(fp, c.topLight, okFlag);
+        put(fp, (uint8_t)(c.checkSpawnFlag ? 1 : 0), okFlag);
+        put(fp, c.chunkFormatVersion, okFlag);
+      }
+      putHistogram(fp, e.histogramBlock, okFlag);
+      putHistogram(fp, e.histogramBiome, okFlag);
+      put(fp, e.geojsonOffset, okFlag);
+      put(fp, e.geojsonSize, okFlag);
+      put(fp, e.geojsonCount, okFlag);
+    }
+    static void getEntry(FILE* fp, const ChunkCacheKey& k, ChunkCacheEntry& e, bool& okFlag) {
+      uint8_t hasChunk = 0;
+      get(fp, e.hash, okFlag);
+      get(fp, hasChunk, okFlag);
+      if ( okFlag && hasChunk ) {
+        e.chunk = std::shared_ptr<ChunkData_LevelDB>(new ChunkData_LevelDB());
+        ChunkData_LevelDB& c = *e.chunk;
+        uint8_t checkSpawn = 0;
+        c.chunkX = std::get<1>(k);
+        c.chunkZ = std::get<2>(k);
+        uint8_t hasGrass = 0;
+        get(fp, c.topBlock, okFlag);
+        get(fp, c.biome, okFlag);
+        get(fp, hasGrass, okFlag);
+        // note: the settings hash makes sure that this matches what we need
+        if ( okFlag && hasGrass && c.grass ) {
+          okFlag = ( fread(c.grass.get(), sizeof(uint32_t), 16 * 16, fp) == 16 * 16 );
+        } else if ( hasGrass || c.grass ) {
+          okFlag = false;
+        }
+        get(fp, c.topBlockY, okFlag);
+        get(fp, c.heightCol, okFlag);
+        get(fp, c.topLight, okFlag);
+        get(fp, checkSpawn, okFlag);
+        get(fp, c.chunkFormatVersion, okFlag);
+        c.checkSpawnFlag = (checkSpawn != 0);
+      }
+      getHistogram(fp, e.histogramBlock, okFlag);
+      getHistogram(fp, e.histogramBiome, okFlag);
+      get(fp, e.geojsonOffset, okFlag);
+      get(fp, e.geojsonSize, okFlag);
+      get(fp, e.geojsonCount, okFlag);
+      // sanity check
+      if ( e.geojsonCount > (16 * 16 * 256) ) {
+        okFlag = false;
       }
+    }
 
-      dbOptions->block_size = control.leveldbBlockSize;
+    // the geojson file is: magic, file id, then the geojson items (each is a string, see putString)
+    void openGeojson(const std::string& fn) {
+      closeGeojson();
+      fnGeojsonTemp = fn + ".geojson.tmp";
+      geojsonFileId = (uint64_t)std::chrono::system_clock::now().time_since_epoch().count();
+      geojsonOkFlag = true;
+      geojsonFp = fopen(fnGeojsonTemp.c_str(), "wb");
+      if ( ! geojsonFp ) {
+        slogger.msg(kLogInfo1,"ERROR: Failed to create chunk cache geojson file (%s) error=%s (%d)\n", fnGeojsonTemp.c_str(), strerror(errno), errno);
+        geojsonOkFlag = false;
+        return;
+      }
+      putString(geojsonFp, kGeojsonMagic, geojsonOkFlag);
+      put(geojsonFp, geojsonFileId, geojsonOkFlag);
+      geojsonOffset = sizeof(uint32_t) + strlen(kGeojsonMagic) + sizeof(geojsonFileId);
+    }
 
-      // start: suggestions from leveldb/mcpe_sample_setup.cpp
-      //create a 40 mb cache (we use this on ~1gb devices)
-      dbOptions->block_cache = leveldb::NewLRUCache(40 * 1024 * 1024);
-      
-      //create a 4mb write buffer, to improve compression and touch the disk less
-      dbOptions->write_buffer_size = 4 * 1024 * 1024;
-      
-      //disable internal logging. The default logger will still print out things to a file
-      dbOptions->info_log = new NullLogger();
+    // returns false if the file is not the one the main file was written with
+    bool openPrevGeojson(const std::string& fn, uint64_t fileId) {
+      prevGeojsonFp = fopen((fn + ".geojson").c_str(), "rb");
+      if ( ! prevGeojsonFp ) {
+        return false;
+      }
+      bool okFlag = true;
+      std::string magic;
+      uint64_t id = 0;
+      getString(prevGeojsonFp, magic, okFlag);
+      get(prevGeojsonFp, id, okFlag);
+      return okFlag && magic == kGeojsonMagic && id == fileId;
+    }
 
-      //use the new raw-zip compressor to write (and read)
-      dbOptions->compressors[0] = new leveldb::ZlibCompressorRaw(-1);
-      
-      //also setup the old, slower compressor for backwards compatibility. This will only be used to read old compressed blocks.
-      dbOptions->compressors[1] = new leveldb::ZlibCompressor();
-      // end: suggestions from leveldb/mcpe_sample_setup.cpp
-      
-      
-      for (int32_t i=0; i < kDimIdCount; i++) {
-        dimDataList[i] = std::unique_ptr<DimensionData_LevelDB>(new DimensionData_LevelDB());
-        dimDataList[i]->setDimId(i);
-        dimDataList[i]->unsetChunkBoundsValid();
+    void closePrevGeojson() {
+      if ( prevGeojsonFp ) {
+        fclose(prevGeojsonFp);
+        prevGeojsonFp = nullptr;
       }
-      dimDataList[kDimIdOverworld]->setName("overworld");
-      dimDataList[kDimIdNether]->setName("nether");
-      dimDataList[kDimIdTheEnd]->setName("the-end");
-    }
-    ~MinecraftWorld_LevelDB() {
-      dbClose();
     }
 
-    int32_t parseLevelFile(const std::string& fname) {
-      FILE *fp = fopen(fname.c_str(), "rb");
-      if(!fp) {
-        slogger.msg(kLogInfo1,"ERROR: Failed to open input file (fn=%s error=%s (%d))\n", fname.c_str(), strerror(errno), errno);
-        return -1;
+    // note: this removes the temp file (if save did not use it)
+    void closeGeojson() {
+      if ( geojsonFp ) {
+        fclose(geojsonFp);
+        geojsonFp = nullptr;
+        deleteFile(fnGeojsonTemp);
       }
+    }
 
-      int32_t fVersion;
-      int32_t bufLen;
-      fread(&fVersion, sizeof(int32_t), 1, fp);
-      fread(&bufLen, sizeof(int32_t), 1, fp);
+    const char* kMagic = "mcpe_viz chunk cache v6";
+    const char* kGeojsonMagic = "mcpe_viz chunk cache geojson v1";
+    const uint32_t kByteOrderMark = 0x01020304;
 
-      slogger.msg(kLogInfo1,"parseLevelFile: name=%s version=%d len=%d\n", fname.c_str(), fVersion, bufLen);
+  public:
+    int32_t hitCt, missCt;
+
+    ChunkCache() {
+      settingsHash = 0;
+      prevLoadedFlag = false;
+      prevOutputHash = outputHash = 0;
+      memset(prevBounds, 0, sizeof(prevBounds));
+      memset(bounds, 0, sizeof(bounds));
+      hitCt = missCt = 0;
+      prevGeojsonFp = geojsonFp = nullptr;
+      geojsonOffset = 0;
+      geojsonOkFlag = false;
+      geojsonFileId = 0;
+    }
 
-      int32_t ret = -2;
-      if ( bufLen > 0 ) { 
-        // read content
-        char* buf = new char[bufLen];
-        fread(buf,1,bufLen,fp);
-        fclose(fp);
+    ~ChunkCache() {
+      closePrevGeojson();
+      closeGeojson();
+    }
 
-        MyNbtTagList tagList;
-        ret = parseNbt("level.dat: ", buf, bufLen, tagList);
-        
-        if ( ret == 0 ) {
-          nbt::tag_compound tc = tagList[0].second->as<nbt::tag_compound>();
+    void setSettingsHash(uint64_t h) {
+      settingsHash = h;
+    }
+
+    // the output hash covers the settings that change the images but not the decoded chunks
+    void setOutputHash(uint64_t h) {
+      outputHash = h;
+    }
+
+    void setBounds(int32_t dimId, int32_t minChunkX, int32_t maxChunkX, int32_t minChunkZ, int32_t maxChunkZ) {
+      bounds[dimId][0] = minChunkX;
+      bounds[dimId][1] = maxChunkX;
+      bounds[dimId][2] = minChunkZ;
+      bounds[dimId][3] = maxChunkZ;
+    }
+    
+    // returns nullptr if the chunk column is not in the cache or if it has changed
+    std::shared_ptr<const ChunkCacheEntry> find(const ChunkCacheKey& k, uint64_t hash) const {
+      const auto& it = prevEntries.find(k);
+      if ( it == prevEntries.end() || it->second->hash != hash ) {
+        return nullptr;
+      }
+      return it->second;
+    }
+
+    // get the geojson items of an entry from find() -- returns -1 if the geojson file can't be read
+    // note: this is called by the worker threads
+    int32_t readGeoJSON(const ChunkCacheEntry& e, std::vector<std::string>& list) {
+      if ( e.geojsonCount == 0 ) {
+        return 0;
+      }
+      std::lock_guard<std::mutex> lock(geojsonMtx);
+      if ( ! prevGeojsonFp || seekFile(prevGeojsonFp, (int64_t)e.geojsonOffset) != 0 ) {
+        return -1;
+      }
+      bool okFlag = true;
+      uint64_t size = 0;
+      for (uint32_t i=0; okFlag && i < e.geojsonCount; i++) {
+        std::string json;
+        getString(prevGeojsonFp, json, okFlag);
+        size += sizeof(uint32_t) + json.size();
+        list.push_back(std::move(json));
+      }
+      return ( okFlag && size == e.geojsonSize ) ? 0 : -1;
+    }
+
+    // put the geojson items of a chunk column in this run's geojson file, and note where they are in the entry
+    // note: this is called by the worker threads, so the items are not in key order in the file
+    void writeGeoJSON(const std::vector<std::string>& list, ChunkCacheEntry& e) {
+      std::lock_guard<std::mutex> lock(geojsonMtx);
+      e.geojsonOffset = geojsonOffset;
+      e.geojsonSize = 0;
+      e.geojsonCount = (uint32_t)list.size();
+      for ( const auto& it : list ) {
+        putString(geojsonFp, it, geojsonOkFlag);
+        e.geojsonSize += sizeof(uint32_t) + (uint32_t)it.size();
+      }
+      geojsonOffset += e.geojsonSize;
+    }
+
+    // note: the entries are new objects (they point into this run's geojson file), so we compare the hashes
+    void add(ChunkCacheList& l) {
+      for ( auto& it : l ) {
+        const auto& itPrev = prevEntries.find(it.first);
+        if ( itPrev == prevEntries.end() || itPrev->second->hash != it.second->hash ) {
+          changedKeys.insert(it.first);
+        }
+        entries[it.first] = std::move(it.second);
+      }
+      l.clear();
+    }
+
+    // get the chunks (in a dimension) that were added, changed or removed since the last run
+    // returns false if we cannot tell (e.g. there was no cache file, the output settings or the world bounds changed)
+    bool getChangedChunks(int32_t dimId, std::vector< std::pair<int32_t, int32_t> >& changed) const {
+      changed.clear();
+      if ( !prevLoadedFlag || prevOutputHash != outputHash || memcmp(prevBounds[dimId], bounds[dimId], sizeof(bounds[dimId])) != 0 ) {
+        return false;
+      }
+      for ( const auto& it : changedKeys ) {
+        if ( std::get<0>(it) == dimId ) {
+          changed.push_back( std::make_pair(std::get<1>(it), std::get<2>(it)) );
+        }
+      }
+      for ( const auto& it : prevEntries ) {
+        if ( std::get<0>(it.first) == dimId && entries.find(it.first) == entries.end() ) {
+          changed.push_back( std::make_pair(std::get<1>(it.first), std::get<2>(it.first)) );
+        }
+      }
+      return true;
+    }
+
+    int32_t load(const std::string& fn) {
+      prevEntries.clear();
+      prevLoadedFlag = false;
+      closePrevGeojson();
+      openGeojson(fn);
+      
+      FILE* fp = fopen(fn.c_str(), "rb");
+      if ( ! fp ) {
+        slogger.msg(kLogInfo1,"  Chunk cache file not found (%s) -- all chunks will be decoded\n", fn.c_str());
+        return -1;
+      }
+
+      bool okFlag = true;
+      std::string magic, version;
+      uint32_t byteOrderMark = 0;
+      uint64_t fileSettingsHash = 0, prevGeojsonFileId = 0;
+      uint32_t n = 0;
+      getString(fp, magic, okFlag);
+      get(fp, byteOrderMark, okFlag);
+      getString(fp, version, okFlag);
+      get(fp, fileSettingsHash, okFlag);
+      get(fp, prevOutputHash, okFlag);
+      get(fp, prevBounds, okFlag);
+      get(fp, prevGeojsonFileId, okFlag);
+      if ( !okFlag || magic != kMagic || byteOrderMark != kByteOrderMark || version != mcpe_viz_version_short ||
+           fileSettingsHash != settingsHash ) {
+        slogger.msg(kLogInfo1,"  Chunk cache file (%s) is from a different version or host, or has different settings -- all chunks will be decoded\n", fn.c_str());
+        fclose(fp);
+        return -1;
+      }
+      if ( ! openPrevGeojson(fn, prevGeojsonFileId) ) {
+        slogger.msg(kLogInfo1,"  Chunk cache geojson file (%s.geojson) is missing or does not match -- all chunks will be decoded\n", fn.c_str());
+        closePrevGeojson();
+        fclose(fp);
+        return -1;
+      }
+      
+      get(fp, n, okFlag);
+      for (uint32_t i=0; okFlag && i < n; i++) {
+        int32_t dimId = 0, chunkX = 0, chunkZ = 0;
+        get(fp, dimId, okFlag);
+        get(fp, chunkX, okFlag);
+        get(fp, chunkZ, okFlag);
+        ChunkCacheKey k(dimId, chunkX, chunkZ);
+        std::shared_ptr<ChunkCacheEntry> e(new ChunkCacheEntry());
+        getEntry(fp, k, *e, okFlag);
+        prevEntries[k] = e;
+      }
+      fclose(fp);
+
+      if ( ! okFlag ) {
+        slogger.msg(kLogInfo1,"ERROR: Failed to read chunk cache file (%s) -- all chunks will be decoded\n", fn.c_str());
+        prevEntries.clear();
+        closePrevGeojson();
+        return -1;
+      }
+      prevLoadedFlag = true;
+      
+      slogger.msg(kLogInfo1,"  Read %d chunk columns from chunk cache file (%s)\n", (int)prevEntries.size(), fn.c_str());
+      return 0;
+    }
+
+    int32_t save(const std::string& fn) {
+      // the geojson file goes first -- if we fail after this, the old main file does not match it and is not used
+      // note: we close the old geojson file first because windows can't replace a file that is open
+      closePrevGeojson();
+      std::string fnGeojson = fn + ".geojson";
+      if ( geojsonFp && fclose(geojsonFp) != 0 ) {
+        geojsonOkFlag = false;
+      }
+      geojsonFp = nullptr;
+      if ( !geojsonOkFlag || replaceFile(fnGeojsonTemp, fnGeojson) != 0 ) {
+        slogger.msg(kLogInfo1,"ERROR: Failed to write chunk cache geojson file (%s) error=%s (%d)\n", fnGeojson.c_str(), strerror(errno), errno);
+        deleteFile(fnGeojsonTemp);
+        return -1;
+      }
+      
+      // we write to a temp file so that a failed write does not leave a broken cache file
+      std::string fnTemp = fn + ".tmp";
+      FILE* fp = fopen(fnTemp.c_str(), "wb");
+      if ( ! fp ) {
+        slogger.msg(kLogInfo1,"ERROR: Failed to create chunk cache file (%s) error=%s (%d)\n", fnTemp.c_str(), strerror(errno), errno);
+        return -1;
+      }
+
+      bool okFlag = true;
+      putString(fp, kMagic, okFlag);
+      put(fp, kByteOrderMark, okFlag);
+      putString(fp, mcpe_viz_version_short, okFlag);
+      put(fp, settingsHash, okFlag);
+      put(fp, outputHash, okFlag);
+      put(fp, bounds, okFlag);
+      put(fp, geojsonFileId, okFlag);
+      put(fp, (uint32_t)entries.size(), okFlag);
+      for ( const auto& it : entries ) {
+        put(fp, std::get<0>(it.first), okFlag);
+        put(fp, std::get<1>(it.first), okFlag);
+        put(fp, std::get<2>(it.first), okFlag);
+        putEntry(fp, *it.second, okFlag);
+      }
+      if ( fclose(fp) != 0 ) {
+        okFlag = false;
+      }
+      
+      if ( !okFlag || replaceFile(fnTemp, fn) != 0 ) {
+        slogger.msg(kLogInfo1,"ERROR: Failed to write chunk cache file (%s) error=%s (%d)\n", fn.c_str(), strerror(errno), errno);
+        deleteFile(fnTemp);
+        return -1;
+      }
+
+      slogger.msg(kLogInfo1,"  Wrote %d chunk columns to chunk cache file (%s)\n", (int)entries.size(), fn.c_str());
+      return 0;
+    }
+  };
+
+  
+  // a leveldb record copied out of the iterator for the dbParse worker threads (--threads)
+  class DbParseRecord {
+  public:
+    std::string key;
+    std::string value;
+
+    // results from the worker thread (terrain records only)
+    bool decodedFlag;
+    LogCaptureList log;
+    std::vector<std::string> listGeoJSON;
+
+    DbParseRecord(const leveldb::Slice& k, const leveldb::Slice& v)
+      : key(k.data(), k.size())
+      , value(v.data(), v.size())
+      , decodedFlag(false) {
+    }
+  };
+
+  // a batch of records, with the chunks and histograms decoded from them by a worker thread
+  // note: a batch always ends on a chunk column boundary
+  class DbParseBatch {
+  public:
+    std::vector<DbParseRecord> records;
+    bool decodedFlag;
+    ChunkData_LevelDB_Map chunks[kDimIdCount];
+    Histogram histogramBlock[kDimIdCount];
+    Histogram histogramBiome[kDimIdCount];
+
+    // --chunk-cache
+    ChunkCacheList cacheEntries;
+    int32_t cacheHitCt, cacheMissCt;
+
+    // --top-only
+    int64_t subChunkDecodeCt, subChunkSkipCt;
+
+    DbParseBatch() {
+      decodedFlag = false;
+      cacheHitCt = cacheMissCt = 0;
+      subChunkDecodeCt = subChunkSkipCt = 0;
+    }
+  };
+
+  // passes batches from the reader threads to the worker threads, and then (in read order) to the main thread
+  // note: there is one stream of batches per reader thread (key range); the main thread takes the streams in order
+  class DbParseQueue {
+  private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector< std::deque< std::unique_ptr<DbParseBatch> > > inflight;
+    std::vector<bool> readerDoneFlag;
+    std::deque< DbParseBatch* > todo;
+    size_t maxInflight;
+    size_t readerDoneCount;
+
+  public:
+    DbParseQueue(size_t numStreams, size_t tmaxInflight)
+      : inflight(numStreams)
+      , readerDoneFlag(numStreams, false) {
+      maxInflight = std::max((size_t)1, tmaxInflight);
+      readerDoneCount = 0;
+    }
+
+    // reader thread: blocks while too many batches are in flight (this limits memory use)
+    void push(size_t stream, std::unique_ptr<DbParseBatch> batch) {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv.wait(lock, [this,stream]() { return inflight[stream].size() < maxInflight; });
+      todo.push_back(batch.get());
+      inflight[stream].push_back(std::move(batch));
+      cv.notify_all();
+    }
+
+    void setReaderDone(size_t stream) {
+      std::unique_lock<std::mutex> lock(mtx);
+      readerDoneFlag[stream] = true;
+      readerDoneCount++;
+      cv.notify_all();
+    }
+
+    // worker thread: returns nullptr when there is no more work
+    DbParseBatch* nextTodo() {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv.wait(lock, [this]() { return !todo.empty() || readerDoneCount >= readerDoneFlag.size(); });
+      if ( todo.empty() ) {
+        return nullptr;
+      }
+      DbParseBatch* batch = todo.front();
+      todo.pop_front();
+      return batch;
+    }
+
+    void setDecoded(DbParseBatch* batch) {
+      std::unique_lock<std::mutex> lock(mtx);
+      batch->decodedFlag = true;
+      cv.notify_all();
+    }
+
+    // main thread: returns the batches of a stream in the order they were read, nullptr when the stream is done
+    std::unique_ptr<DbParseBatch> nextDecoded(size_t stream) {
+      std::unique_lock<std::mutex> lock(mtx);
+      std::deque< std::unique_ptr<DbParseBatch> >& q = inflight[stream];
+      cv.wait(lock, [this,stream,&q]() { return (!q.empty() && q.front()->decodedFlag) || (readerDoneFlag[stream] && q.empty()); });
+      if ( q.empty() ) {
+        return nullptr;
+      }
+      std::unique_ptr<DbParseBatch> batch = std::move(q.front());
+      q.pop_front();
+      cv.notify_all();
+      return batch;
+    }
+  };
+    
+
+
+  // base class for a minecraft world
+  class MinecraftWorld {
+  private:
+    std::string worldName;
+    int64_t worldSeed;
+    int32_t worldSpawnX;
+    int32_t worldSpawnY;
+    int32_t worldSpawnZ;
+
+  public:
+    MinecraftWorld() {
+      worldName = "UNKNOWN-NOT-SET";
+      worldSeed = 0;
+      worldSpawnX = 0;
+      worldSpawnY = 0;
+      worldSpawnZ = 0;
+    }
+
+    void setWorldName(const std::string& s) { worldName = s; }
+    const std::string& getWorldName() const { return worldName; }
+
+    void setWorldSeed(int64_t s) { worldSeed = s; }
+    int64_t getWorldSeed() const { return worldSeed; }
+
+    void setWorldSpawnX(int32_t v) { worldSpawnX = v; }
+    int32_t getWorldSpawnX() const { return worldSpawnX; }
+    void setWorldSpawnY(int32_t v) { worldSpawnY = v; }
+    int32_t getWorldSpawnY() const { return worldSpawnY; }
+    void setWorldSpawnZ(int32_t v) { worldSpawnZ = v; }
+    int32_t getWorldSpawnZ() const { return worldSpawnZ; }
+  };
+
+
+  class MinecraftWorld_LevelDB : public MinecraftWorld {
+  private:
+    leveldb::DB* db;
+    std::unique_ptr<leveldb::Options> dbOptions;
+    int32_t totalRecordCt;
+    ChunkCache chunkCache;
+    // --top-only
+    int64_t subChunkDecodeCt, subChunkSkipCt;
+
+    // --chunk-cache: the tiles that need to be written for each dimension (if valid)
+    TileSet dirtyTileList[kDimIdCount];
+    bool dirtyTileListValid[kDimIdCount];
+  
+  public:
+    // todobig - move to private?
+    std::unique_ptr<DimensionData_LevelDB> dimDataList[kDimIdCount];
+
+    MinecraftWorld_LevelDB() {
+      db = nullptr;
+      totalRecordCt = 0;
+      subChunkDecodeCt = subChunkSkipCt = 0;
+      for (int32_t i=0; i < kDimIdCount; i++) {
+        dirtyTileListValid[i] = false;
+      }
+      
+      levelDbReadOptions.fill_cache = false;
+      // suggestion from leveldb/mcpe_sample_setup.cpp
+      levelDbReadOptions.decompress_allocator = new leveldb::DecompressAllocator();
+
+
+      dbOptions = std::unique_ptr<leveldb::Options>(new leveldb::Options);
+      //dbOptions->compressors[0] = new leveldb::ZlibCompressor();
+      dbOptions->create_if_missing = false;
+
+      // this filter is supposed to reduce disk reads - light testing indicates that it is faster when doing 'html-all'
+      if ( control.leveldbFilter > 0 ) {
+        dbOptions->filter_policy = leveldb::NewBloomFilterPolicy(control.leveldbFilter);
+      }
+
+      dbOptions->block_size = control.leveldbBlockSize;
+
+      // start: suggestions from leveldb/mcpe_sample_setup.cpp
+      //create a 40 mb cache (we use this on ~1gb devices)
+      dbOptions->block_cache = leveldb::NewLRUCache(40 * 1024 * 1024);
+      
+      //create a 4mb write buffer, to improve compression and touch the disk less
+      dbOptions->write_buffer_size = 4 * 1024 * 1024;
+      
+      //disable internal logging. The default logger will still print out things to a file
+      dbOptions->info_log = new NullLogger();
+
+      //use the new raw-zip compressor to write (and read)
+      dbOptions->compressors[0] = new leveldb::ZlibCompressorRaw(-1);
+      
+      //also setup the old, slower compressor for backwards compatibility. This will only be used to read old compressed blocks.
+      dbOptions->compressors[1] = new leveldb::ZlibCompressor();
+      // end: suggestions from leveldb/mcpe_sample_setup.cpp
+      
+      
+      for (int32_t i=0; i < kDimIdCount; i++) {
+        dimDataList[i] = std::unique_ptr<DimensionData_LevelDB>(new DimensionData_LevelDB());
+        dimDataList[i]->setDimId(i);
+        dimDataList[i]->unsetChunkBoundsValid();
+      }
+      dimDataList[kDimIdOverworld]->setName("overworld");
+      dimDataList[kDimIdNether]->setName("nether");
+      dimDataList[kDimIdTheEnd]->setName("the-end");
+    }
+    ~MinecraftWorld_LevelDB() {
+      dbClose();
+    }
+
+    int32_t parseLevelFile(const std::string& fname) {
+      FILE *fp = fopen(fname.c_str(), "rb");
+      if(!fp) {
+        slogger.msg(kLogInfo1,"ERROR: Failed to open input file (fn=%s error=%s (%d))\n", fname.c_str(), strerror(errno), errno);
+        return -1;
+      }
+
+      int32_t fVersion;
+      int32_t bufLen;
+      fread(&fVersion, sizeof(int32_t), 1, fp);
+      fread(&bufLen, sizeof(int32_t), 1, fp);
+
+      slogger.msg(kLogInfo1,"parseLevelFile: name=%s version=%d len=%d\n", fname.c_str(), fVersion, bufLen);
+
+      int32_t ret = -2;
+      if ( bufLen > 0 ) { 
+        // read content
+        char* buf = new char[bufLen];
+        fread(buf,1,bufLen,fp);
+        fclose(fp);
+
+        MyNbtTagList tagList;
+        ret = parseNbt("level.dat: ", buf, bufLen, tagList);
+        
+        if ( ret == 0 ) {
+          nbt::tag_compound tc = tagList[0].second->as<nbt::tag_compound>();
 
           setWorldSpawnX( tc["SpawnX"].as<nbt::tag_int>().get() );
           setWorldSpawnY( tc["SpawnY"].as<nbt::tag_int>().get() );
@@ -4220,40 +5916,70 @@ namespace mcpe_viz {
       return 0;
     }
 
-    int32_t calcChunkBounds() {
-      // see if we already calculated bounds
-      bool passFlag = true;
-      for (int32_t i=0; i < kDimIdCount; i++) {
-        if ( ! dimDataList[i]->getChunkBoundsValid() ) {
-          passFlag = false;
-        }
-      }
-      if ( passFlag ) {
+    // split the key space into (approximately) equal-sized ranges so that it can be iterated in parallel
+    // rangeStart gets the first key of each range; a range ends where the next one starts
+    // note: we split on the first byte of the key so that a chunk column is never split between ranges
+    int32_t calcKeyRanges(int32_t numRanges, std::vector<std::string>& rangeStart) {
+      rangeStart.clear();
+      rangeStart.push_back("");
+      if ( numRanges <= 1 ) {
         return 0;
       }
 
-      // clear bounds
-      for (int32_t i=0; i < kDimIdCount; i++) {
-        dimDataList[i]->unsetChunkBoundsValid();
+      std::vector<std::string> bucketKeys(257);
+      for (int32_t i=0; i < 256; i++) {
+        bucketKeys[i] = std::string(1, (char)i);
+      }
+      // todo - there could be keys past this, but they would be very odd keys
+      bucketKeys[256] = std::string(16, (char)0xff);
+
+      std::vector<leveldb::Range> buckets(256);
+      for (int32_t i=0; i < 256; i++) {
+        buckets[i] = leveldb::Range(bucketKeys[i], bucketKeys[i+1]);
+      }
+      std::vector<uint64_t> sizes(256, 0);
+      db->GetApproximateSizes(buckets.data(), 256, sizes.data());
+
+      uint64_t total = 0;
+      for (int32_t i=0; i < 256; i++) {
+        total += sizes[i];
+      }
+      if ( total == 0 ) {
+        // no size info (e.g. everything is still in the log file), so we just split the first byte evenly
+        for (int32_t i=0; i < 256; i++) {
+          sizes[i] = 1;
+        }
+        total = 256;
+      }
+
+      uint64_t cumSize = 0;
+      for (int32_t i=0; i < 255; i++) {
+        cumSize += sizes[i];
+        if ( (int32_t)rangeStart.size() < numRanges && (cumSize * numRanges) >= (total * rangeStart.size()) ) {
+          rangeStart.push_back(bucketKeys[i+1]);
+        }
       }
 
+      slogger.msg(kLogInfo1,"  Split keys into %d ranges (approx db size = %.1lf MB)\n", (int32_t)rangeStart.size(), (double)total / (1024.0 * 1024.0));
+      return 0;
+    }
+
+    // scan the keys in one range for calcChunkBounds
+    int32_t calcChunkBoundsRange(const std::string& keyStart, const std::string& keyEnd, ChunkBoundsScan& scan) {
       int32_t chunkX=-1, chunkZ=-1, chunkDimId=-1, chunkType=-1;
-        
-      slogger.msg(kLogInfo1,"Scan keys to get world boundaries\n");
-      int32_t recordCt = 0;
 
       // todobig - is there a faster way to enumerate the keys?
       leveldb::Iterator* iter = db->NewIterator(levelDbReadOptions);
       leveldb::Slice skey;
       int32_t key_size;
       const char* key;
-      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      for (iterSeek(iter, keyStart); iterInRange(iter, keyEnd); iter->Next()) {
         skey = iter->key();
         key_size = skey.size();
         key = skey.data();
           
-        ++recordCt;
-        if ( control.shortRunFlag && recordCt > 1000 ) {
+        ++scan.recordCt;
+        if ( control.shortRunFlag && scan.recordCt > 1000 ) {
           break;
         }
           
@@ -4266,7 +5992,7 @@ namespace mcpe_viz {
           if ( chunkType == 0x30 ) {
             // pre-0.17 chunk block data
             if ( legalChunkPos(chunkX,chunkZ) ) {
-              dimDataList[0]->addToChunkBounds(chunkX, chunkZ);
+              scan.add(0, chunkX, chunkZ);
             }
           }
         }
@@ -4279,7 +6005,7 @@ namespace mcpe_viz {
           // sanity checks
           if ( chunkType == 0x2f ) {
             if ( legalChunkPos(chunkX,chunkZ) ) {
-              dimDataList[0]->addToChunkBounds(chunkX, chunkZ);
+              scan.add(0, chunkX, chunkZ);
             }
           }
         }
@@ -4293,7 +6019,7 @@ namespace mcpe_viz {
           // sanity checks
           if ( chunkType == 0x30 ) {
             if ( legalChunkPos(chunkX,chunkZ) ) {
-              dimDataList[chunkDimId]->addToChunkBounds(chunkX, chunkZ);
+              scan.add(chunkDimId, chunkX, chunkZ);
             }
           }
         }
@@ -4307,16 +6033,66 @@ namespace mcpe_viz {
           // sanity checks
           if ( chunkType == 0x2f ) {
             if ( legalChunkPos(chunkX,chunkZ) ) {
-              dimDataList[chunkDimId]->addToChunkBounds(chunkX, chunkZ);
+              scan.add(chunkDimId, chunkX, chunkZ);
             }
           }
         }
       }
 
-      if (!iter->status().ok()) {
-        slogger.msg(kLogInfo1,"WARNING: LevelDB operation returned status=%s\n",iter->status().ToString().c_str());
-      }
+      scan.statusOk = iter->status().ok();
+      scan.statusString = iter->status().ToString();
       delete iter;
+      return 0;
+    }
+    
+    int32_t calcChunkBounds() {
+      // see if we already calculated bounds
+      bool passFlag = true;
+      for (int32_t i=0; i < kDimIdCount; i++) {
+        if ( ! dimDataList[i]->getChunkBoundsValid() ) {
+          passFlag = false;
+        }
+      }
+      if ( passFlag ) {
+        return 0;
+      }
+
+      // clear bounds
+      for (int32_t i=0; i < kDimIdCount; i++) {
+        dimDataList[i]->unsetChunkBoundsValid();
+      }
+
+      slogger.msg(kLogInfo1,"Scan keys to get world boundaries\n");
+
+      // note: shortrun is only done with a single range
+      std::vector<std::string> keyRanges;
+      calcKeyRanges(control.shortRunFlag ? 1 : control.threadCount, keyRanges);
+
+      std::vector<ChunkBoundsScan> scans(keyRanges.size());
+      if ( keyRanges.size() > 1 ) {
+        std::vector<std::thread> threads;
+        for (size_t i=0; i < keyRanges.size(); i++) {
+          const std::string keyEnd = ( (i+1) < keyRanges.size() ) ? keyRanges[i+1] : std::string("");
+          threads.push_back(std::thread(&MinecraftWorld_LevelDB::calcChunkBoundsRange, this, keyRanges[i], keyEnd, std::ref(scans[i])));
+        }
+        for ( auto& it : threads ) {
+          it.join();
+        }
+      } else {
+        calcChunkBoundsRange("", "", scans[0]);
+      }
+
+      int32_t recordCt = 0;
+      for ( const auto& scan : scans ) {
+        recordCt += scan.recordCt;
+        for (int32_t i=0; i < kDimIdCount; i++) {
+          dimDataList[i]->addToChunkBounds(scan.minChunkX[i], scan.minChunkZ[i]);
+          dimDataList[i]->addToChunkBounds(scan.maxChunkX[i], scan.maxChunkZ[i]);
+        }
+        if (!scan.statusOk) {
+          slogger.msg(kLogInfo1,"WARNING: LevelDB operation returned status=%s\n",scan.statusString.c_str());
+        }
+      }
 
       // mark bounds valid
       for (int32_t i=0; i < kDimIdCount; i++) {
@@ -4333,14 +6109,18 @@ namespace mcpe_viz {
     // this is where we go through every item in the leveldb, we parse interesting things as we go
     int32_t dbParse () {
 
-      char tmpstring[256];
-
-      int32_t chunkX=-1, chunkZ=-1, chunkDimId=-1, chunkType=-1, chunkTypeSub=-1;
-      int32_t chunkFormatVersion = 2; //todonow - get properly
-
-
       // we make sure that we know the chunk bounds before we start so that we can translate world coords to image coords
-      calcChunkBounds();
+      // note: in single-pass mode we get the bounds as we go and translate coords when we are done
+      if ( control.singlePassFlag ) {
+        for (int32_t i=0; i < kDimIdCount; i++) {
+          dimDataList[i]->unsetChunkBoundsValid();
+        }
+        totalRecordCt = 0;
+      } else {
+        calcChunkBounds();
+      }
+      // note: the chunk cache keeps geojson with world coords so that it does not depend on the bounds
+      deferImageCoordsFlag = control.singlePassFlag || control.chunkCacheFlag;
 
       // report hide and force lists
       {
@@ -4371,481 +6151,917 @@ namespace mcpe_viz {
           slogger.msg(kLogInfo1,"None\n");
         }
       }
-            
+
+      if ( control.chunkCacheFlag ) {
+        chunkCache.setSettingsHash(hashDecodeSettings());
+        chunkCache.setOutputHash(hashOutputSettings());
+        chunkCache.load(control.fnChunkCache);
+      }
+      
       slogger.msg(kLogInfo1,"Parse all leveldb records\n");
 
       MyNbtTagList tagList;
-      int32_t recordCt = 0, ret;
+      int32_t recordCt = 0;
+      bool statusOk = true;
+      std::string statusString;
 
-      leveldb::Slice skey, svalue;
-      size_t key_size;
-      size_t cdata_size;
-      const char* key;
-      const char* cdata;
-      std::string dimName, chunkstr;
+      if ( control.threadCount > 1 ) {
+        dbParse_threads(tagList, recordCt, statusOk, statusString);
+      } else {
+        // --chunk-cache and --top-only: the terrain records of the current chunk column
+        std::unique_ptr<DbParseBatch> column(new DbParseBatch());
+        
+        leveldb::Iterator* iter = db->NewIterator(levelDbReadOptions);
+        for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
 
-      leveldb::Iterator* iter = db->NewIterator(levelDbReadOptions);
-      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+          // note: we get the raw buffer early to avoid overhead (maybe?)
+          leveldb::Slice skey = iter->key();
+          leveldb::Slice svalue = iter->value();
 
-        // note: we get the raw buffer early to avoid overhead (maybe?)
-        skey = iter->key();
-        key_size = (int)skey.size();
-        key = skey.data();
+          ++recordCt;
+          if ( control.shortRunFlag && recordCt > 1000 ) {
+            break;
+          }
+          dbParseProgress(recordCt);
+
+          if ( control.chunkCacheFlag || control.topOnlyFlag ) {
+            dbParseColumnRecord(column, skey, svalue, tagList);
+          } else {
+            dbParseRecord(skey.data(), skey.size(), svalue.data(), svalue.size(), nullptr, tagList);
+          }
+        }
+        if ( control.chunkCacheFlag || control.topOnlyFlag ) {
+          dbParseFlushColumn(column, tagList);
+        }
+        statusOk = iter->status().ok();
+        statusString = iter->status().ToString();
+        delete iter;
+      }
+      
+      slogger.msg(kLogInfo1,"Read %d records\n", recordCt);
+      slogger.msg(kLogInfo1,"Status: %s\n", statusString.c_str());
+      
+      if (!statusOk) {
+        slogger.msg(kLogInfo1,"WARNING: LevelDB operation returned status=%s\n",statusString.c_str());
+      }
+
+      if ( deferImageCoordsFlag ) {
+        dbParseFinishDeferred(recordCt);
+      }
+
+      int64_t chunkCt, chunkBytes, allocCt, highWater;
+      ChunkData_LevelDB::getMemoryUse(chunkCt, chunkBytes);
+      if ( chunkCt > 0 ) {
+        slogger.msg(kLogInfo1,"Chunk memory: %lld chunks, %lld bytes per chunk (%.1f MB)\n"
+                    , (long long int)chunkCt, (long long int)(chunkBytes / chunkCt), (double)chunkBytes / (1024.0 * 1024.0));
+      }
+      int64_t clipCt = ChunkData_LevelDB::clipCount();
+      if ( clipCt > 0 ) {
+        slogger.msg(kLogInfo1,"WARNING: %lld top blocks had a block id > %d or block data > %d -- the extra bits were dropped\n"
+                    , (long long int)clipCt, (int)ChunkData_LevelDB::kTopBlockIdMask, (int)ChunkData_LevelDB::kTopBlockDataMask);
+      }
+      ChunkData_LevelDB::pool().getStats(allocCt, highWater);
+      slogger.msg(kLogInfo1,"Chunk slabs: %lld allocations, high-water %lld chunks\n", (long long int)allocCt, (long long int)highWater);
+      BumpArena::getStats(allocCt, highWater);
+      slogger.msg(kLogInfo1,"NBT arena: %lld allocations, high-water %lld bytes\n", (long long int)allocCt, (long long int)highWater);
+      int64_t paletteHitCt, paletteMissCt, paletteCt;
+      chunkPaletteCache.getStats(paletteHitCt, paletteMissCt, paletteCt);
+      if ( (paletteHitCt + paletteMissCt) > 0 ) {
+        slogger.msg(kLogInfo1,"Chunk palettes: %lld distinct, %lld hits, %lld misses (%.1f%% hit rate)\n"
+                    , (long long int)paletteCt, (long long int)paletteHitCt, (long long int)paletteMissCt
+                    , 100.0 * (double)paletteHitCt / (double)(paletteHitCt + paletteMissCt));
+      }
+      
+      if ( control.topOnlyFlag ) {
+        slogger.msg(kLogInfo1,"Top only: decoded %lld sub-chunks, skipped %lld buried sub-chunks\n"
+                    , (long long int)subChunkDecodeCt, (long long int)subChunkSkipCt);
+      }
+      if ( control.chunkCacheFlag ) {
+        slogger.msg(kLogInfo1,"Chunk cache: %d chunk columns unchanged, %d decoded\n", chunkCache.hitCt, chunkCache.missCt);
+        for (int32_t i=0; i < kDimIdCount; i++) {
+          chunkCache.setBounds(i, dimDataList[i]->getMinChunkX(), dimDataList[i]->getMaxChunkX(),
+                               dimDataList[i]->getMinChunkZ(), dimDataList[i]->getMaxChunkZ());
+        }
+      }
+      
+      return 0;
+    }
+
+    // --chunk-cache: anything else that changes the images (we use this to decide which tiles need to be made)
+    // note: only the settings that change the pixels -- options like --threads or --log must not make every tile dirty
+    uint64_t hashOutputSettings() {
+      uint64_t h = kHashBytesInit;
+      const int32_t settings[] = {
+        control.tileWidth, control.tileHeight, control.heightMode,
+        control.doImageBiome, control.doImageGrass, control.doImageHeightCol, control.doImageHeightColGrayscale,
+        control.doImageHeightColAlpha, control.doImageLightBlock, control.doImageLightSky, control.doImageSlimeChunks,
+        control.doImageShadedRelief
+      };
+      h = hashBytes(h, (const char*)settings, sizeof(settings));
+      // the block lists (hide, force-top et al)
+      for (int32_t i=0; i < kDimIdCount; i++) {
+        h = dimDataList[i]->hashDecodeSettings(h);
+      }
+      for (int32_t i=0; i < 512; i++) {
+        h = hashBytes(h, (const char*)&blockInfoList[i].color, sizeof(blockInfoList[i].color));
+        for ( const auto& it : blockInfoList[i].variantList ) {
+          h = hashBytes(h, (const char*)&it->color, sizeof(it->color));
+        }
+      }
+      for ( const auto& it : biomeInfoList ) {
+        h = hashBytes(h, (const char*)&it.first, sizeof(it.first));
+        h = hashBytes(h, (const char*)&it.second->color, sizeof(it.second->color));
+      }
+      return h;
+    }
+
+    // --chunk-cache: anything that changes how chunks are decoded must be in this hash
+    uint64_t hashDecodeSettings() {
+      uint64_t h = kHashBytesInit;
+      for (int32_t i=0; i < 512; i++) {
+        const BlockInfo& b = blockInfoList[i];
+        const uint8_t flags[] = { b.valid, b.solidFlag, b.opaqueFlag, b.liquidFlag, b.spawnableFlag };
+        h = hashBytes(h, (const char*)flags, sizeof(flags));
+        h = hashBytes(h, b.name.data(), b.name.size() + 1);
+        for ( const auto& it : b.unameList ) {
+          h = hashBytes(h, it.data(), it.size() + 1);
+        }
+        for ( const auto& it : b.variantList ) {
+          h = hashBytes(h, (const char*)&it->blockdata, sizeof(it->blockdata));
+          h = hashBytes(h, (const char*)&it->spawnableFlag, sizeof(it->spawnableFlag));
+          h = hashBytes(h, it->name.data(), it->name.size() + 1);
+          for ( const auto& itu : it->unameList ) {
+            h = hashBytes(h, itu.data(), itu.size() + 1);
+          }
+        }
+      }
+      for (int32_t i=0; i < kDimIdCount; i++) {
+        h = dimDataList[i]->hashDecodeSettings(h);
+      }
+      // we only keep the grass color when we need it
+      const uint8_t grassFlag = ( control.doImageGrass != kDoOutputNone );
+      h = hashBytes(h, (const char*)&grassFlag, sizeof(grassFlag));
+      // --top-only changes the block histograms
+      const uint8_t topOnlyFlag = control.topOnlyFlag;
+      h = hashBytes(h, (const char*)&topOnlyFlag, sizeof(topOnlyFlag));
+      return h;
+    }
+    
+    // we saved world coords during dbParse (--single-pass or --chunk-cache), now we translate them to image coords
+    int32_t dbParseFinishDeferred(int32_t recordCt) {
+      if ( control.singlePassFlag ) {
+        // now we know the bounds
+        for (int32_t i=0; i < kDimIdCount; i++) {
+          dimDataList[i]->setChunkBoundsValid();
+          dimDataList[i]->reportChunkBounds();
+        }
+        totalRecordCt = recordCt;
+      }
+      deferImageCoordsFlag = false;
+
+      int32_t rebaseCt = (int32_t)geojsonSink.transform([](std::string& s) -> bool {
+          return rebaseGeojsonCoords(s) > 0;
+        });
+      worldPointToGeoJSONPoint(playerPositionDimensionId, playerPositionWorldX, playerPositionWorldZ, playerPositionImageX, playerPositionImageY);
+      
+      slogger.msg(kLogInfo1,"  Translated %d geojson items to image coordinates\n", rebaseCt);
+      return 0;
+    }
+
+    void dbParseProgress(int32_t recordCt) {
+      if ( (recordCt % 10000) == 0 ) {
+        if ( totalRecordCt <= 0 ) {
+          // single-pass mode -- we don't know how many records there are
+          slogger.msg(kLogInfo1, "  Processing records: %d\n", recordCt);
+        } else {
+          double pct = (double)recordCt / (double)totalRecordCt;
+          slogger.msg(kLogInfo1, "  Processing records: %d / %d (%.1lf%%)\n", recordCt, totalRecordCt, (pct * 100.0));
+        }
+      }
+    }
+
+    // put the log output and geojson from a record that was decoded by a worker thread
+    void dbParseReplay(DbParseRecord& rec) {
+      Logger::replayCapture(rec.log);
+      geojsonSink.add(rec.listGeoJSON);
+      rec.log.clear();
+    }
+    
+    // --threads: reader threads (one per key range) copy records into batches, worker threads decode the terrain
+    // records (the expensive part), and this thread handles the batches in key order so that the output is
+    // identical to the single-threaded output
+    int32_t dbParse_threads(MyNbtTagList& tagList, int32_t& recordCt, bool& statusOk, std::string& statusString) {
+      // todo - param for batch size?
+      const size_t batchSize = 256;
+
+      // note: shortrun is only done with a single range
+      std::vector<std::string> keyRanges;
+      calcKeyRanges(control.shortRunFlag ? 1 : control.threadCount, keyRanges);
+      const size_t numRanges = keyRanges.size();
+      
+      DbParseQueue queue(numRanges, control.threadCount * 4);
+      // note: not vector<bool> -- the readers set their own element concurrently
+      std::vector<uint8_t> rangeStatusOk(numRanges, 1);
+      std::vector<std::string> rangeStatusString(numRanges);
+
+      slogger.msg(kLogInfo1,"  Using %d threads to decode chunks\n", control.threadCount);
+
+      std::vector<std::thread> readers;
+      for (size_t r=0; r < numRanges; r++) {
+        readers.push_back(std::thread([&,r]() {
+              const std::string keyEnd = ( (r+1) < numRanges ) ? keyRanges[r+1] : std::string("");
+              leveldb::Iterator* iter = db->NewIterator(levelDbReadOptions);
+              std::unique_ptr<DbParseBatch> batch(new DbParseBatch());
+              char prevPrefix[8];
+              size_t prevPrefixLen = 0;
+              int32_t readCt = 0;
+              for (iterSeek(iter, keyRanges[r]); iterInRange(iter, keyEnd); iter->Next()) {
+                leveldb::Slice skey = iter->key();
+
+                ++readCt;
+                if ( control.shortRunFlag && readCt > 1000 ) {
+                  break;
+                }
+
+                // we only cut a batch when the chunk x,z (first 8 bytes of key) changes so that a chunk is never split
+                size_t prefixLen = std::min((size_t)8, (size_t)skey.size());
+                bool samePrefix = (prefixLen == prevPrefixLen) && (memcmp(prevPrefix, skey.data(), prefixLen) == 0);
+                if ( batch->records.size() >= batchSize && !samePrefix ) {
+                  queue.push(r, std::move(batch));
+                  batch = std::unique_ptr<DbParseBatch>(new DbParseBatch());
+                }
+                memcpy(prevPrefix, skey.data(), prefixLen);
+                prevPrefixLen = prefixLen;
+            
+                batch->records.emplace_back(skey, iter->value());
+              }
+              if ( batch->records.size() > 0 ) {
+                queue.push(r, std::move(batch));
+              }
+              rangeStatusOk[r] = iter->status().ok();
+              rangeStatusString[r] = iter->status().ToString();
+              delete iter;
+              queue.setReaderDone(r);
+            }));
+      }
+
+      std::vector<std::thread> workers;
+      for (int32_t i=0; i < control.threadCount; i++) {
+        workers.push_back(std::thread([&]() {
+              DbParseBatch* batch;
+              while ( (batch = queue.nextTodo()) != nullptr ) {
+                dbParseDecodeBatch(*batch);
+                queue.setDecoded(batch);
+              }
+            }));
+      }
+
+      for (size_t r=0; r < numRanges; r++) {
+        std::unique_ptr<DbParseBatch> batch;
+        while ( (batch = queue.nextDecoded(r)) != nullptr ) {
+          for ( auto& rec : batch->records ) {
+            ++recordCt;
+            dbParseProgress(recordCt);
+            dbParseRecord(rec.key.data(), rec.key.size(), rec.value.data(), rec.value.size(), &rec, tagList);
+          }
+          dbParseMergeBatch(*batch);
+        }
+      }
+
+      for ( auto& it : readers ) {
+        it.join();
+      }
+      for ( auto& it : workers ) {
+        it.join();
+      }
+
+      // report the first failed range (if any)
+      statusOk = true;
+      statusString = rangeStatusString[0];
+      for (size_t r=0; r < numRanges; r++) {
+        if ( ! rangeStatusOk[r] ) {
+          statusOk = false;
+          statusString = rangeStatusString[r];
+          break;
+        }
+      }
+      
+      return 0;
+    }
+
+    // move the chunks, histograms (and chunk cache entries) from a decoded batch to the dimensions
+    void dbParseMergeBatch(DbParseBatch& batch) {
+      for (int32_t did=0; did < kDimIdCount; did++) {
+        dimDataList[did]->mergeChunks(batch.chunks[did], batch.histogramBlock[did], batch.histogramBiome[did]);
+      }
+      chunkCache.add(batch.cacheEntries);
+      chunkCache.hitCt += batch.cacheHitCt;
+      chunkCache.missCt += batch.cacheMissCt;
+      subChunkDecodeCt += batch.subChunkDecodeCt;
+      subChunkSkipCt += batch.subChunkSkipCt;
+    }
+
+    // --chunk-cache without --threads: we hold the terrain records of a chunk column until we have all of them,
+    // and then we handle them the same way as a batch from the worker threads
+    // note: the terrain records of a chunk column are together in key order
+    int32_t dbParseColumnRecord(std::unique_ptr<DbParseBatch>& column, const leveldb::Slice& skey, const leveldb::Slice& svalue,
+                                MyNbtTagList& tagList) {
+      std::string key(skey.data(), skey.size());
+      int32_t chunkDimId, chunkX, chunkZ;
+      bool terrainFlag = parseTerrainKey(key, chunkDimId, chunkX, chunkZ);
+
+      if ( column->records.size() > 0 ) {
+        int32_t colDimId, colX, colZ;
+        parseTerrainKey(column->records.front().key, colDimId, colX, colZ);
+        if ( !terrainFlag || chunkDimId != colDimId || chunkX != colX || chunkZ != colZ ) {
+          dbParseFlushColumn(column, tagList);
+        }
+      }
+
+      if ( terrainFlag ) {
+        column->records.emplace_back(skey, svalue);
+        return 0;
+      }
+      return dbParseRecord(skey.data(), skey.size(), svalue.data(), svalue.size(), nullptr, tagList);
+    }
+
+    int32_t dbParseFlushColumn(std::unique_ptr<DbParseBatch>& column, MyNbtTagList& tagList) {
+      if ( column->records.size() == 0 ) {
+        return 0;
+      }
+      dbParseDecodeBatch(*column);
+      for ( auto& rec : column->records ) {
+        dbParseRecord(rec.key.data(), rec.key.size(), rec.value.data(), rec.value.size(), &rec, tagList);
+      }
+      dbParseMergeBatch(*column);
+      column.reset(new DbParseBatch());
+      return 0;
+    }
+    
+    // decode one terrain record into the given chunk map, histograms and geojson list
+    // note: this must match the version selection in dbParseRecord
+    int32_t dbParseDecodeTerrain(DbParseRecord& rec, int32_t chunkDimId, int32_t chunkX, int32_t chunkZ,
+                                 int32_t chunkType, int32_t chunkTypeSub, int32_t chunkFormatVersion,
+                                 ChunkData_LevelDB_Map& tchunks, Histogram& hBlock, Histogram& hBiome,
+                                 std::vector<std::string>& tlistGeoJSON) {
+      DimensionData_LevelDB* dimData = dimDataList[chunkDimId].get();
+      const char* cdata = rec.value.data();
+      size_t cdata_size = rec.value.size();
+      
+      switch ( chunkType ) {
+      case 0x30:
+        return dimData->addChunk(tchunks, hBlock, hBiome, tlistGeoJSON, 2, chunkX, 0, chunkZ, cdata, cdata_size);
+      case 0x2f:
+        return dimData->addChunk(tchunks, hBlock, hBiome, tlistGeoJSON, (cdata[0] != 0) ? 7 : chunkFormatVersion,
+                                 chunkX, chunkTypeSub, chunkZ, cdata, cdata_size);
+      case 0x2d:
+        return dimData->addChunkColumnData(tchunks, hBiome, 3, chunkX, chunkZ, cdata, cdata_size);
+      }
+      return -1;
+    }
+
+    // --chunk-cache and --top-only: decode the terrain records (batch.records[first..last-1]) of one chunk column,
+    // or use the chunk cache if the records have not changed
+    // note: the log output goes with each record (as without the cache), the geojson for the column goes with the last record
+    int32_t dbParseDecodeColumn(DbParseBatch& batch, size_t first, size_t last) {
+      int32_t chunkX=-1, chunkZ=-1, chunkDimId=-1, chunkType=-1, chunkTypeSub=-1;
+      int32_t chunkFormatVersion = 2;
+      DbParseRecord& lastRec = batch.records[last-1];
+
+      uint64_t hash = kHashBytesInit;
+      if ( control.chunkCacheFlag ) {
+        for (size_t i=first; i < last; i++) {
+          const DbParseRecord& rec = batch.records[i];
+          hash = hashBytes(hash, rec.key.data(), rec.key.size());
+          hash = hashBytes(hash, rec.value.data(), rec.value.size());
+        }
+      }
+
+      parseTerrainKey(lastRec.key, chunkDimId, chunkX, chunkZ);
+      ChunkCacheKey cacheKey(chunkDimId, chunkX, chunkZ);
+      std::shared_ptr<const ChunkCacheEntry> prevEntry;
+      if ( control.chunkCacheFlag ) {
+        prevEntry = chunkCache.find(cacheKey, hash);
+      }
+
+      std::shared_ptr<ChunkCacheEntry> entry(new ChunkCacheEntry());
+      // note: if we can't read the geojson items from the cache we decode the chunk column
+      if ( prevEntry && chunkCache.readGeoJSON(*prevEntry, lastRec.listGeoJSON) == 0 ) {
+        batch.cacheHitCt++;
+        *entry = *prevEntry;
+      } else {
+        lastRec.listGeoJSON.clear();
+        ChunkData_LevelDB_Map tchunks;
+        Histogram hBlock, hBiome;
+        entry->hash = hash;
+        const ChunkKey chunkKey(chunkX, chunkZ);
+        // --top-only: we decode the sub-chunks from the top down, and stop once every column has a top block
+        // note: sub-chunks are in key order (bottom up), and the top block scan does not depend on the order
+        const bool topOnlyFlag = control.topOnlyFlag && dimDataList[chunkDimId]->getTopOnlyOk();
+        // note: each record keeps its own log output so that the log is in the same order as without the cache
+        for (size_t i=first; i < last; i++) {
+          DbParseRecord& rec = batch.records[i];
+          parseTerrainKey(rec.key.data(), rec.key.size(), chunkX, chunkZ, chunkDimId, chunkType, chunkTypeSub, chunkFormatVersion);
+          if ( topOnlyFlag && chunkType == 0x2f ) {
+            continue;
+          }
+          Logger::setCapture(&rec.log);
+          dbParseDecodeTerrain(rec, chunkDimId, chunkX, chunkZ, chunkType, chunkTypeSub, chunkFormatVersion,
+                               tchunks, hBlock, hBiome, lastRec.listGeoJSON);
+          Logger::setCapture(nullptr);
+        }
+        if ( topOnlyFlag ) {
+          bool doneFlag = false;
+          for (size_t i=last; i-- > first; ) {
+            DbParseRecord& rec = batch.records[i];
+            parseTerrainKey(rec.key.data(), rec.key.size(), chunkX, chunkZ, chunkDimId, chunkType, chunkTypeSub, chunkFormatVersion);
+            if ( chunkType != 0x2f ) {
+              continue;
+            }
+            if ( doneFlag ) {
+              batch.subChunkSkipCt++;
+              continue;
+            }
+            Logger::setCapture(&rec.log);
+            dbParseDecodeTerrain(rec, chunkDimId, chunkX, chunkZ, chunkType, chunkTypeSub, chunkFormatVersion,
+                                 tchunks, hBlock, hBiome, lastRec.listGeoJSON);
+            Logger::setCapture(nullptr);
+            batch.subChunkDecodeCt++;
+            const auto& it = tchunks.find(chunkKey);
+            doneFlag = ( it != tchunks.end() && it->second->getTopBlockCount() == (16 * 16) );
+          }
+        }
+        entry->histogramBlock = hBlock.getItems();
+        entry->histogramBiome = hBiome.getItems();
+        const auto& it = tchunks.find(chunkKey);
+        if ( it != tchunks.end() ) {
+          entry->chunk = std::move(it->second);
+        }
+        if ( control.chunkCacheFlag ) {
+          batch.cacheMissCt++;
+        }
+      }
+
+      // note: the batch shares the chunk with the cache entry -- without --chunk-cache the entry is dropped below,
+      //   so the batch ends up as the only owner
+      if ( entry->chunk ) {
+        batch.chunks[chunkDimId][ChunkKey(chunkX, chunkZ)] = entry->chunk;
+      }
+      batch.histogramBlock[chunkDimId].merge(entry->histogramBlock);
+      batch.histogramBiome[chunkDimId].merge(entry->histogramBiome);
+      for (size_t i=first; i < last; i++) {
+        batch.records[i].decodedFlag = true;
+      }
+      if ( control.chunkCacheFlag ) {
+        chunkCache.writeGeoJSON(lastRec.listGeoJSON, *entry);
+        batch.cacheEntries.emplace_back(cacheKey, entry);
+      }
+      return 0;
+    }
+    
+    // worker thread: decode the terrain records in a batch into the batch's chunk maps and histograms
+    // note: log output is captured per-record and is put in order by dbParseRecord
+    int32_t dbParseDecodeBatch(DbParseBatch& batch) {
+      int32_t chunkX=-1, chunkZ=-1, chunkDimId=-1, chunkType=-1, chunkTypeSub=-1;
+      int32_t chunkFormatVersion = 2;
+
+      if ( control.chunkCacheFlag || control.topOnlyFlag ) {
+        // we find the runs of terrain records for each chunk column
+        // note: batches never split a chunk column
+        size_t i = 0;
+        while ( i < batch.records.size() ) {
+          if ( ! parseTerrainKey(batch.records[i].key, chunkDimId, chunkX, chunkZ) ) {
+            i++;
+            continue;
+          }
+          size_t j = i + 1;
+          int32_t nextDimId, nextX, nextZ;
+          while ( j < batch.records.size() &&
+                  parseTerrainKey(batch.records[j].key, nextDimId, nextX, nextZ) &&
+                  nextDimId == chunkDimId && nextX == chunkX && nextZ == chunkZ ) {
+            j++;
+          }
+          dbParseDecodeColumn(batch, i, j);
+          i = j;
+        }
+        return 0;
+      }
+      
+      for ( auto& rec : batch.records ) {
+        if ( ! parseTerrainKey(rec.key.data(), rec.key.size(), chunkX, chunkZ, chunkDimId, chunkType, chunkTypeSub, chunkFormatVersion) ) {
+          continue;
+        }
+        
+        Logger::setCapture(&rec.log);
+        dbParseDecodeTerrain(rec, chunkDimId, chunkX, chunkZ, chunkType, chunkTypeSub, chunkFormatVersion,
+                             batch.chunks[chunkDimId], batch.histogramBlock[chunkDimId], batch.histogramBiome[chunkDimId],
+                             rec.listGeoJSON);
+        Logger::setCapture(nullptr);
+        rec.decodedFlag = true;
+      }
+      return 0;
+    }
+
+    // parse one leveldb record
+    // rec is non-null when using --threads (terrain records in rec have already been decoded)
+    int32_t dbParseRecord(const char* key, size_t key_size, const char* cdata, size_t cdata_size, DbParseRecord* rec, MyNbtTagList& tagList) {
+      char tmpstring[256];
+      int32_t chunkX=-1, chunkZ=-1, chunkDimId=-1, chunkType=-1, chunkTypeSub=-1;
+      int32_t chunkFormatVersion = 2; //todonow - get properly
+      int32_t ret;
+      std::string dimName, chunkstr;
 
-        svalue = iter->value();
-        cdata_size = svalue.size();
-        cdata = svalue.data();
+      logger.msg(kLogInfo1,"\n");
 
-        ++recordCt;
-        if ( control.shortRunFlag && recordCt > 1000 ) {
-          break;
-        }
-        if ( (recordCt % 10000) == 0 ) {
-          double pct = (double)recordCt / (double)totalRecordCt;
-          slogger.msg(kLogInfo1, "  Processing records: %d / %d (%.1lf%%)\n", recordCt, totalRecordCt, (pct * 100.0));
-        }
+      // we look at the key to determine what we have, some records have text keys
 
-        logger.msg(kLogInfo1,"\n");
+      if ( strncmp(key,"BiomeData",key_size) == 0 ) {
+        // 0x61 +"BiomeData" -- snow accum? -- overworld only?
+        logger.msg(kLogInfo1,"BiomeData value:\n");
+        parseNbt("BiomeData: ", cdata, cdata_size, tagList);
+        // todo - parse tagList? snow accumulation amounts
+      }
 
-        // we look at the key to determine what we have, some records have text keys
+      else if ( strncmp(key,"Overworld",key_size) == 0 ) {
+        logger.msg(kLogInfo1,"Overworld value:\n");
+        parseNbt("Overworld: ", cdata, cdata_size, tagList);
+        // todo - parse tagList? a list of "LimboEntities"
+      }
 
-        if ( strncmp(key,"BiomeData",key_size) == 0 ) {
-          // 0x61 +"BiomeData" -- snow accum? -- overworld only?
-          logger.msg(kLogInfo1,"BiomeData value:\n");
-          parseNbt("BiomeData: ", cdata, cdata_size, tagList);
-          // todo - parse tagList? snow accumulation amounts
+      else if ( strncmp(key,"~local_player",key_size) == 0 ) {
+        logger.msg(kLogInfo1,"Local Player value:\n");
+        ret = parseNbt("Local Player: ", cdata, cdata_size, tagList);
+        if ( ret == 0 ) { 
+          parseNbt_entity(-1, "",tagList, true, false, "Local Player", "");
         }
+      }
 
-        else if ( strncmp(key,"Overworld",key_size) == 0 ) {
-          logger.msg(kLogInfo1,"Overworld value:\n");
-          parseNbt("Overworld: ", cdata, cdata_size, tagList);
-          // todo - parse tagList? a list of "LimboEntities"
-        }
+      else if ( (key_size>=7) && (strncmp(key,"player_",7) == 0) ) {
+        // note: key contains player id (e.g. "player_-1234")
+        std::string playerRemoteId = std::string(&key[strlen("player_")], key_size - strlen("player_"));
+        
+        logger.msg(kLogInfo1,"Remote Player (id=%s) value:\n",playerRemoteId.c_str());
 
-        else if ( strncmp(key,"~local_player",key_size) == 0 ) {
-          logger.msg(kLogInfo1,"Local Player value:\n");
-          ret = parseNbt("Local Player: ", cdata, cdata_size, tagList);
-          if ( ret == 0 ) { 
-            parseNbt_entity(-1, "",tagList, true, false, "Local Player", "");
-          }
+        ret = parseNbt("Remote Player: ", cdata, cdata_size, tagList);
+        if ( ret == 0 ) {
+          parseNbt_entity(-1, "",tagList, false, true, "Remote Player", playerRemoteId);
         }
+      }
 
-        else if ( (key_size>=7) && (strncmp(key,"player_",7) == 0) ) {
-          // note: key contains player id (e.g. "player_-1234")
-          std::string playerRemoteId = std::string(&key[strlen("player_")], key_size - strlen("player_"));
-          
-          logger.msg(kLogInfo1,"Remote Player (id=%s) value:\n",playerRemoteId.c_str());
+      else if ( strncmp(key,"villages",key_size) == 0 ) {
+        logger.msg(kLogInfo1,"Villages value:\n");
+        parseNbt("villages: ", cdata, cdata_size, tagList);
+        // todo - parse tagList? usually empty, unless player is in range of village; test that!
+      }
 
-          ret = parseNbt("Remote Player: ", cdata, cdata_size, tagList);
-          if ( ret == 0 ) {
-            parseNbt_entity(-1, "",tagList, false, true, "Remote Player", playerRemoteId);
-          }
+      else if ( strncmp(key,"mVillages",key_size) == 0 ) {
+        // todobig -- new for 0.13? what is it?
+        logger.msg(kLogInfo1,"mVillages value:\n");
+        ret = parseNbt("mVillages: ", cdata, cdata_size, tagList);
+        if ( ret == 0 ) {
+          parseNbt_mVillages(tagList);
         }
+      }
 
-        else if ( strncmp(key,"villages",key_size) == 0 ) {
-          logger.msg(kLogInfo1,"Villages value:\n");
-          parseNbt("villages: ", cdata, cdata_size, tagList);
-          // todo - parse tagList? usually empty, unless player is in range of village; test that!
-        }
+      else if ( strncmp(key,"game_flatworldlayers",key_size) == 0 ) {
+        // todobig -- what is it?
+        // example data (standard flat): 5b 37 2c 33 2c 33 2c 32 5d
+        logger.msg(kLogInfo1,"game_flatworldlayers value: (todo)\n");
+        // parseNbt("game_flatworldlayers: ", cdata, cdata_size, tagList);
+        // todo - parse tagList?
+      }
+      
+      else if ( strncmp(key,"idcounts",key_size) == 0 ) {
+        // todobig -- new for 0.13? what is it? is it a 4-byte int?
+        logger.msg(kLogInfo1,"idcounts value:\n");
+        parseNbt("idcounts: ", cdata, cdata_size, tagList);
+      }
 
-        else if ( strncmp(key,"mVillages",key_size) == 0 ) {
-          // todobig -- new for 0.13? what is it?
-          logger.msg(kLogInfo1,"mVillages value:\n");
-          ret = parseNbt("mVillages: ", cdata, cdata_size, tagList);
-          if ( ret == 0 ) {
-            parseNbt_mVillages(tagList);
-          }
-        }
+      else if ( strncmp(key,"Nether",key_size) == 0 ) {
+        logger.msg(kLogInfo1,"Nether value:\n");
+        parseNbt("Nether: ", cdata, cdata_size, tagList);
+        // todo - parse tagList?  list of LimboEntities
+      }
 
-        else if ( strncmp(key,"game_flatworldlayers",key_size) == 0 ) {
-          // todobig -- what is it?
-          // example data (standard flat): 5b 37 2c 33 2c 33 2c 32 5d
-          logger.msg(kLogInfo1,"game_flatworldlayers value: (todo)\n");
-          // parseNbt("game_flatworldlayers: ", cdata, cdata_size, tagList);
-          // todo - parse tagList?
+      else if ( strncmp(key,"portals",key_size) == 0 ) {
+        logger.msg(kLogInfo1,"portals value:\n");
+        ret = parseNbt("portals: ", cdata, cdata_size, tagList);
+        if ( ret == 0 ) {
+          parseNbt_portals(tagList);
         }
+      }
+
+      else if ( strncmp(key,"AutonomousEntities",key_size) == 0 ) {
+        logger.msg(kLogInfo1,"AutonomousEntities value:\n");
+        ret = parseNbt("AutonomousEntities: ", cdata, cdata_size, tagList);
+        // todostopper - what to do with this info?
+        //          if ( ret == 0 ) {
+        //            parseNbt_portals(tagList);
+        //          }
+      }
+      
+      // todohere todonow -- new record like "dimension0" - presumably for other dims too
+      //           looks like it could be partially text? nbt?
+      /*
+        WARNING: Unparsed Record: 
+        key_size=10 
+        key_string=[dimension0^AC<93><9A>] 
+        key_hex=[64 69 6d 65 6e 73 69 6f 6e 30] 
+        value_size=65 
+        value_hex=[0a 00 00 0a 09 00 6d 69 6e 65 73 68 61 66 74 00 0a 06 00 6f 63 65 61 6e 73 00 0a 09 00 73 63 61 74 74 65 72 65 64 00 0a 0a 00 73 74 72 6f 6e 67 68 6f 6c 64 00 0a 07 00 76 69 6c 6c 61 67 65 00 00]
+
+
+        UNK: NBT Decode Start
+        UNK: [] COMPOUND-1 {
+        UNK:   [mineshaft] COMPOUND-2 {
+        UNK:   } COMPOUND-2
+        UNK:   [oceans] COMPOUND-3 {
+        UNK:   } COMPOUND-3
+        UNK:   [scattered] COMPOUND-4 {
+        UNK:   } COMPOUND-4
+        UNK:   [stronghold] COMPOUND-5 {
+        UNK:   } COMPOUND-5
+        UNK:   [village] COMPOUND-6 {
+        UNK:   } COMPOUND-6
+        UNK: } COMPOUND-1
+        UNK: NBT Decode End (1 tags)
         
-        else if ( strncmp(key,"idcounts",key_size) == 0 ) {
-          // todobig -- new for 0.13? what is it? is it a 4-byte int?
-          logger.msg(kLogInfo1,"idcounts value:\n");
-          parseNbt("idcounts: ", cdata, cdata_size, tagList);
-        }
+      */
+      else if ( strncmp(key,"dimension",9) == 0 ) {
+        std::string keyString(key, key_size);
+        logger.msg(kLogInfo1,"Dimension chunk -- key: (%s) value:\n", keyString.c_str());
+        ret = parseNbt("Dimension: ", cdata, cdata_size, tagList);
+        // todostopper - what to do with this info?
+        //          if ( ret == 0 ) {
+        //            parseNbt_portals(tagList);
+        //          }
+      }
+      
+      else if ( key_size == 9 || key_size == 10 || key_size == 13 || key_size == 14 ) {
 
-        else if ( strncmp(key,"Nether",key_size) == 0 ) {
-          logger.msg(kLogInfo1,"Nether value:\n");
-          parseNbt("Nether: ", cdata, cdata_size, tagList);
-          // todo - parse tagList?  list of LimboEntities
-        }
+        // these are probably chunk records, we parse the key and determine what we've got
 
-        else if ( strncmp(key,"portals",key_size) == 0 ) {
-          logger.msg(kLogInfo1,"portals value:\n");
-          ret = parseNbt("portals: ", cdata, cdata_size, tagList);
-          if ( ret == 0 ) {
-            parseNbt_portals(tagList);
-          }
+        if ( parseChunkKey(key, key_size, chunkX, chunkZ, chunkDimId, chunkType, chunkTypeSub, chunkFormatVersion, dimName) != 0 ) {
+          slogger.msg(kLogInfo1, "WARNING: UNKNOWN -- Found new chunkDimId=0x%x -- we are not prepared for that -- skipping chunk\n", chunkDimId);
+          return 0;
         }
 
-        else if ( strncmp(key,"AutonomousEntities",key_size) == 0 ) {
-          logger.msg(kLogInfo1,"AutonomousEntities value:\n");
-          ret = parseNbt("AutonomousEntities: ", cdata, cdata_size, tagList);
-          // todostopper - what to do with this info?
-          //          if ( ret == 0 ) {
-          //            parseNbt_portals(tagList);
-          //          }
-        }
-        
-        // todohere todonow -- new record like "dimension0" - presumably for other dims too
-        //           looks like it could be partially text? nbt?
-        /*
-          WARNING: Unparsed Record: 
-          key_size=10 
-          key_string=[dimension0^AC<93><9A>] 
-          key_hex=[64 69 6d 65 6e 73 69 6f 6e 30] 
-          value_size=65 
-          value_hex=[0a 00 00 0a 09 00 6d 69 6e 65 73 68 61 66 74 00 0a 06 00 6f 63 65 61 6e 73 00 0a 09 00 73 63 61 74 74 65 72 65 64 00 0a 0a 00 73 74 72 6f 6e 67 68 6f 6c 64 00 0a 07 00 76 69 6c 6c 61 67 65 00 00]
-
-
-          UNK: NBT Decode Start
-          UNK: [] COMPOUND-1 {
-          UNK:   [mineshaft] COMPOUND-2 {
-          UNK:   } COMPOUND-2
-          UNK:   [oceans] COMPOUND-3 {
-          UNK:   } COMPOUND-3
-          UNK:   [scattered] COMPOUND-4 {
-          UNK:   } COMPOUND-4
-          UNK:   [stronghold] COMPOUND-5 {
-          UNK:   } COMPOUND-5
-          UNK:   [village] COMPOUND-6 {
-          UNK:   } COMPOUND-6
-          UNK: } COMPOUND-1
-          UNK: NBT Decode End (1 tags)
-          
-        */
-        else if ( strncmp(key,"dimension",9) == 0 ) {
-          std::string keyString(key, key_size);
-          logger.msg(kLogInfo1,"Dimension chunk -- key: (%s) value:\n", keyString.c_str());
-          ret = parseNbt("Dimension: ", cdata, cdata_size, tagList);
-          // todostopper - what to do with this info?
-          //          if ( ret == 0 ) {
-          //            parseNbt_portals(tagList);
-          //          }
+        // we check for corrupt chunks
+        if ( ! legalChunkPos(chunkX,chunkZ) ) {
+          slogger.msg(kLogInfo1,"WARNING: Found a chunk with invalid chunk coordinates cx=%d cz=%d\n", chunkX, chunkZ);
+          return 0;
         }
-        
-        else if ( key_size == 9 || key_size == 10 || key_size == 13 || key_size == 14 ) {
 
-          // these are probably chunk records, we parse the key and determine what we've got
+        dimDataList[chunkDimId]->addHistogramChunkType(chunkType);
 
-          chunkTypeSub = 0;
-          
-          if ( key_size == 9 ) {
-            // overworld chunk
-            chunkX = myParseInt32(key, 0);
-            chunkZ = myParseInt32(key, 4);
-            chunkDimId = kDimIdOverworld;
-            chunkType = myParseInt8(key, 8);
-            dimName = "overworld";
-            chunkFormatVersion = 2; //todonow - get properly
-          }
-          else if ( key_size == 10 ) {
-            // overworld chunk
-            chunkX = myParseInt32(key, 0);
-            chunkZ = myParseInt32(key, 4);
-            chunkDimId = kDimIdOverworld;
-            chunkType = myParseInt8(key, 8);
-            chunkTypeSub = myParseInt8(key, 9); // todonow - rename
-            dimName = "overworld";
-            chunkFormatVersion = 3; //todonow - get properly
-          }
-          else if ( key_size == 13 ) {
-            // non-overworld chunk
-            chunkX = myParseInt32(key, 0);
-            chunkZ = myParseInt32(key, 4);
-            chunkDimId = myParseInt32(key, 8);
-            chunkType = myParseInt8(key, 12);
-            dimName = "nether";
-            chunkFormatVersion = 2; //todonow - get properly
-
-            // adjust weird dim id's
-            if ( chunkDimId == 0x32373639 ) {
-              chunkDimId = kDimIdTheEnd;
-            }
-            if ( chunkDimId == 0x33373639 ) {
-              chunkDimId = kDimIdNether;
-            }
-            
-            // check for new dim id's
-            if ( chunkDimId != kDimIdNether && chunkDimId != kDimIdTheEnd ) {
-              slogger.msg(kLogInfo1, "WARNING: UNKNOWN -- Found new chunkDimId=0x%x -- we are not prepared for that -- skipping chunk\n", chunkDimId);
-              continue;
-            }
+        if ( control.singlePassFlag ) {
+          // single-pass mode -- same rules as calcChunkBounds
+          if ( ( chunkType == 0x30 && (key_size == 9 || key_size == 13) ) ||
+               ( chunkType == 0x2f && (key_size == 10 || key_size == 14) ) ) {
+            dimDataList[chunkDimId]->addToChunkBounds(chunkX, chunkZ);
           }
-          else if ( key_size == 14 ) {
-            // non-overworld chunk
-            chunkX = myParseInt32(key, 0);
-            chunkZ = myParseInt32(key, 4);
-            chunkDimId = myParseInt32(key, 8);
-            chunkType = myParseInt8(key, 12);
-            chunkTypeSub = myParseInt8(key, 13); // todonow - rename
-            dimName = "nether";
-            chunkFormatVersion = 3; //todonow - get properly
-
-            // adjust weird dim id's
-            if ( chunkDimId == 0x32373639 ) {
-              chunkDimId = kDimIdTheEnd;
-            }
-            if ( chunkDimId == 0x33373639 ) {
-              chunkDimId = kDimIdNether;
-            }
-
-            // check for new dim id's
-            if ( chunkDimId != kDimIdNether && chunkDimId != kDimIdTheEnd ) {
-              slogger.msg(kLogInfo1, "WARNING: UNKNOWN -- Found new chunkDimId=0x%x -- we are not prepared for that -- skipping chunk\n", chunkDimId);
-              continue;
-            }
+        }
+        
+        // report info about the chunk
+        chunkstr = dimName + "-chunk: ";
+        sprintf(tmpstring,"%d %d (type=0x%02x) (subtype=0x%02x) (size=%d)", chunkX, chunkZ, chunkType, chunkTypeSub, (int32_t)cdata_size);
+        chunkstr += tmpstring;
+        if ( ! deferImageCoordsFlag ) {
+          // show approximate image coordinates for chunk
+          double tix, tiy;
+          dimDataList[chunkDimId]->worldPointToImagePoint(chunkX*16, chunkZ*16, tix, tiy, false);
+          int32_t imageX = tix;
+          int32_t imageZ = tiy;
+          sprintf(tmpstring," (image %d %d)", (int32_t)imageX, (int32_t)imageZ);
+          chunkstr+=tmpstring;
+        }
+        logger.msg(kLogInfo1, "%s\n", chunkstr.c_str());
+
+        // see what kind of chunk we have
+        // tommo posted useful info about the various record types here (around 0.17 beta):
+        //   https://www.reddit.com/r/MCPE/comments/5cw2tm/level_format_changes_in_mcpe_0171_100/
+        switch ( chunkType ) {
+        case 0x30:
+          // "LegacyTerrain"
+          // chunk block data
+          // we do the parsing in the destination object to save memcpy's
+          // todonow - would be better to get the version # from the proper chunk record (0x76)
+          if ( rec != nullptr && rec->decodedFlag ) {
+            // already decoded by a worker thread
+            dbParseReplay(*rec);
+          } else {
+            dimDataList[chunkDimId]->addChunk(2, chunkX, 0, chunkZ,cdata,cdata_size);
           }
+          break;
 
-          // we check for corrupt chunks
-          if ( ! legalChunkPos(chunkX,chunkZ) ) {
-            slogger.msg(kLogInfo1,"WARNING: Found a chunk with invalid chunk coordinates cx=%d cz=%d\n", chunkX, chunkZ);
-            continue;
+        case 0x31:
+          // "BlockEntity"
+          // tile entity record (e.g. a chest)
+          logger.msg(kLogInfo1,"%s 0x31 chunk (tile entity data):\n", dimName.c_str());
+          ret = parseNbt("0x31-te: ", cdata, cdata_size, tagList);
+          if ( ret == 0 ) { 
+            parseNbt_tileEntity(chunkDimId, dimName+"-", tagList);
           }
+          break;
 
-          dimDataList[chunkDimId]->addHistogramChunkType(chunkType);
-
-          // report info about the chunk
-          chunkstr = dimName + "-chunk: ";
-          sprintf(tmpstring,"%d %d (type=0x%02x) (subtype=0x%02x) (size=%d)", chunkX, chunkZ, chunkType, chunkTypeSub, (int32_t)cdata_size);
-          chunkstr += tmpstring;
-          if ( true ) {
-            // show approximate image coordinates for chunk
-            double tix, tiy;
-            dimDataList[chunkDimId]->worldPointToImagePoint(chunkX*16, chunkZ*16, tix, tiy, false);
-            int32_t imageX = tix;
-            int32_t imageZ = tiy;
-            sprintf(tmpstring," (image %d %d)", (int32_t)imageX, (int32_t)imageZ);
-            chunkstr+=tmpstring;
+        case 0x32:
+          // "Entity"
+          // entity record (e.g. a mob)
+          logger.msg(kLogInfo1,"%s 0x32 chunk (entity data):\n", dimName.c_str());
+          ret = parseNbt("0x32-e: ", cdata, cdata_size, tagList);
+          if ( ret == 0 ) {
+            parseNbt_entity(chunkDimId, dimName+"-", tagList, false, false, "", "");
           }
-          logger.msg(kLogInfo1, "%s\n", chunkstr.c_str());
-
-          // see what kind of chunk we have
-          // tommo posted useful info about the various record types here (around 0.17 beta):
-          //   https://www.reddit.com/r/MCPE/comments/5cw2tm/level_format_changes_in_mcpe_0171_100/
-          switch ( chunkType ) {
-          case 0x30:
-            // "LegacyTerrain"
-            // chunk block data
-            // we do the parsing in the destination object to save memcpy's
-            // todonow - would be better to get the version # from the proper chunk record (0x76)
-            dimDataList[chunkDimId]->addChunk(2, chunkX, 0, chunkZ,cdata,cdata_size);
-            break;
-
-          case 0x31:
-            // "BlockEntity"
-            // tile entity record (e.g. a chest)
-            logger.msg(kLogInfo1,"%s 0x31 chunk (tile entity data):\n", dimName.c_str());
-            ret = parseNbt("0x31-te: ", cdata, cdata_size, tagList);
-            if ( ret == 0 ) { 
-              parseNbt_tileEntity(chunkDimId, dimName+"-", tagList);
-            }
-            break;
-
-          case 0x32:
-            // "Entity"
-            // entity record (e.g. a mob)
-            logger.msg(kLogInfo1,"%s 0x32 chunk (entity data):\n", dimName.c_str());
-            ret = parseNbt("0x32-e: ", cdata, cdata_size, tagList);
-            if ( ret == 0 ) {
-              parseNbt_entity(chunkDimId, dimName+"-", tagList, false, false, "", "");
-            }
-            break;
-
-          case 0x33:
-            // "PendingTicks"
-            // todo - this appears to be info on blocks that can move: water + lava + fire + sand + gravel
-            logger.msg(kLogInfo1,"%s 0x33 chunk (tick-list):\n", dimName.c_str());
-            parseNbt("0x33-tick: ", cdata, cdata_size, tagList);
-            // todo - parse tagList?
-            // todobig - could show location of active fires
-            break;
+          break;
 
-          case 0x34:
-            // "BlockExtraData"
-            logger.msg(kLogInfo1,"%s 0x34 chunk (TODO - MYSTERY RECORD - BlockExtraData)\n", dimName.c_str());
-            if ( control.verboseFlag ) {
-              printKeyValue(key,key_size,cdata,cdata_size,false);
-            }
-            // according to tommo (https://www.reddit.com/r/MCPE/comments/5cw2tm/level_format_changes_in_mcpe_0171_100/)
-            // "BlockExtraData"
-            /* 
-               0x34 ?? does not appear to be NBT data -- overworld only? -- perhaps: b0..3 (count); for each: (int32_t) (int16_t) 
-               -- there are 206 of these in "another1" world
-               -- something to do with snow?
-               -- to examine data:
-               cat (logfile) | grep "WARNING: Unknown key size" | grep " 34\]" | cut -b75- | sort | nl
-            */
-            break;
+        case 0x33:
+          // "PendingTicks"
+          // todo - this appears to be info on blocks that can move: water + lava + fire + sand + gravel
+          logger.msg(kLogInfo1,"%s 0x33 chunk (tick-list):\n", dimName.c_str());
+          parseNbt("0x33-tick: ", cdata, cdata_size, tagList);
+          // todo - parse tagList?
+          // todobig - could show location of active fires
+          break;
 
-          case 0x35:
-            // "BiomeState"
-            logger.msg(kLogInfo1,"%s 0x35 chunk (TODO - MYSTERY RECORD - BiomeState)\n", dimName.c_str());
-            if ( control.verboseFlag ) {
-              printKeyValue(key,key_size,cdata,cdata_size,false);
-            }
-            // according to tommo (https://www.reddit.com/r/MCPE/comments/5cw2tm/level_format_changes_in_mcpe_0171_100/)
-            // "BiomeState"
-            /*
-              0x35 ?? -- both dimensions -- length 3,5,7,9,11 -- appears to be: b0 (count of items) b1..bn (2-byte ints) 
-              -- there are 2907 in "another1"
-              -- to examine data:
-              cat (logfile) | grep "WARNING: Unknown key size" | grep " 35\]" | cut -b75- | sort | nl
-            */
-            break;
+        case 0x34:
+          // "BlockExtraData"
+          logger.msg(kLogInfo1,"%s 0x34 chunk (TODO - MYSTERY RECORD - BlockExtraData)\n", dimName.c_str());
+          if ( control.verboseFlag ) {
+            printKeyValue(key,key_size,cdata,cdata_size,false);
+          }
+          // according to tommo (https://www.reddit.com/r/MCPE/comments/5cw2tm/level_format_changes_in_mcpe_0171_100/)
+          // "BlockExtraData"
+          /* 
+             0x34 ?? does not appear to be NBT data -- overworld only? -- perhaps: b0..3 (count); for each: (int32_t) (int16_t) 
+             -- there are 206 of these in "another1" world
+             -- something to do with snow?
+             -- to examine data:
+             cat (logfile) | grep "WARNING: Unknown key size" | grep " 34\]" | cut -b75- | sort | nl
+          */
+          break;
 
-          case 0x36:
-            // new for v1.2?
-            logger.msg(kLogInfo1,"%s 0x36 chunk (TODO - MYSTERY RECORD - TBD)\n", dimName.c_str());
-            if ( control.verboseFlag ) {
-              printKeyValue(key,key_size,cdata,cdata_size,false);
-            }
-            // todo - what is this?
-            // appears to be a single 4-byte integer?
-            break;
+        case 0x35:
+          // "BiomeState"
+          logger.msg(kLogInfo1,"%s 0x35 chunk (TODO - MYSTERY RECORD - BiomeState)\n", dimName.c_str());
+          if ( control.verboseFlag ) {
+            printKeyValue(key,key_size,cdata,cdata_size,false);
+          }
+          // according to tommo (https://www.reddit.com/r/MCPE/comments/5cw2tm/level_format_changes_in_mcpe_0171_100/)
+          // "BiomeState"
+          /*
+            0x35 ?? -- both dimensions -- length 3,5,7,9,11 -- appears to be: b0 (count of items) b1..bn (2-byte ints) 
+            -- there are 2907 in "another1"
+            -- to examine data:
+            cat (logfile) | grep "WARNING: Unknown key size" | grep " 35\]" | cut -b75- | sort | nl
+          */
+          break;
 
-          case 0x39:
-            // new for v1.2?
-            logger.msg(kLogInfo1,"%s 0x39 chunk (TODO - MYSTERY RECORD - TBD)\n", dimName.c_str());
-            if ( control.verboseFlag ) {
-              printKeyValue(key,key_size,cdata,cdata_size,false);
-            }
-            // todo - what is this?
-            break;
-            
-          case 0x76:
-            // "Version"
-            // todo - this is chunk version information?
-            {
-              // this record is not very interesting, we usually hide it
-              // note: it would be interesting if this is not == 2 (as of MCPE 0.12.x it is always 2)
-              if ( control.verboseFlag || ((cdata[0] != 2) && (cdata[0] != 3) && (cdata[0] != 9)) ) {
-                if ( cdata[0] != 2 && cdata[0] != 9 ) { 
-                  logger.msg(kLogInfo1,"WARNING: UNKNOWN CHUNK VERSION!  %s 0x76 chunk (world format version): v=%d\n", dimName.c_str(), (int)(cdata[0]));
-                } else {
-                  logger.msg(kLogInfo1,"%s 0x76 chunk (world format version): v=%d\n", dimName.c_str(), (int)(cdata[0]));
-                }
-              }
-            }
-            break;
+        case 0x36:
+          // new for v1.2?
+          logger.msg(kLogInfo1,"%s 0x36 chunk (TODO - MYSTERY RECORD - TBD)\n", dimName.c_str());
+          if ( control.verboseFlag ) {
+            printKeyValue(key,key_size,cdata,cdata_size,false);
+          }
+          // todo - what is this?
+          // appears to be a single 4-byte integer?
+          break;
 
-          case 0x2f:
-            // "SubchunkPrefix"
-            // chunk block data - 10241 bytes
-            // todonow -- but have also seen 6145 on v1.1?
-            // we do the parsing in the destination object to save memcpy's
-            // todonow - would be better to get the version # from the proper chunk record (0x76)
-            {
-              int32_t chunkY = chunkTypeSub;
-              // check the first byte to see if anything interesting is in it
-              if ( cdata[0] != 0 ) {
-                //logger.msg(kLogInfo1, "WARNING: UNKNOWN Byte 0 of 0x2f chunk: b0=[%d 0x%02x]\n", (int)cdata[0], (int)cdata[0]);
-                dimDataList[chunkDimId]->addChunk(7, chunkX, chunkY, chunkZ, cdata, cdata_size);
+        case 0x39:
+          // new for v1.2?
+          logger.msg(kLogInfo1,"%s 0x39 chunk (TODO - MYSTERY RECORD - TBD)\n", dimName.c_str());
+          if ( control.verboseFlag ) {
+            printKeyValue(key,key_size,cdata,cdata_size,false);
+          }
+          // todo - what is this?
+          break;
+          
+        case 0x76:
+          // "Version"
+          // todo - this is chunk version information?
+          {
+            // this record is not very interesting, we usually hide it
+            // note: it would be interesting if this is not == 2 (as of MCPE 0.12.x it is always 2)
+            if ( control.verboseFlag || ((cdata[0] != 2) && (cdata[0] != 3) && (cdata[0] != 9)) ) {
+              if ( cdata[0] != 2 && cdata[0] != 9 ) { 
+                logger.msg(kLogInfo1,"WARNING: UNKNOWN CHUNK VERSION!  %s 0x76 chunk (world format version): v=%d\n", dimName.c_str(), (int)(cdata[0]));
               } else {
-                if ( cdata_size != 6145 && cdata_size != 10241 ) {
-                  logger.msg(kLogInfo1, "WARNING: UNKNOWN cdata_size=%d of 0x2f chunk\n", (int)cdata_size);
-                }                
-                dimDataList[chunkDimId]->addChunk(chunkFormatVersion, chunkX, chunkY, chunkZ, cdata, cdata_size);
+                logger.msg(kLogInfo1,"%s 0x76 chunk (world format version): v=%d\n", dimName.c_str(), (int)(cdata[0]));
               }
             }
-            break;
+          }
+          break;
 
-          case 0x2d:
-            // "Data2D"
-            // chunk column data - 768 bytes
-            // format appears to be:
-            // 16x16 of 2-byte ints for HEIGHT OF TOP BLOCK
-            // 8x8 of 4-byte ints for BIOME and GRASS COLOR
-            // todonow todobig todohere -- this appears to be an MCPE bug, it should be 16x16, right?
-            // also - grass colors are pretty weird (some are 01 01 01)
-            
-            // todonow - would be better to get the version # from the proper chunk record (0x76)
-            {
-              dimDataList[chunkDimId]->addChunkColumnData(3, chunkX, chunkZ, cdata, cdata_size);
+        case 0x2f:
+          // "SubchunkPrefix"
+          // chunk block data - 10241 bytes
+          // todonow -- but have also seen 6145 on v1.1?
+          // we do the parsing in the destination object to save memcpy's
+          // todonow - would be better to get the version # from the proper chunk record (0x76)
+          {
+            int32_t chunkY = chunkTypeSub;
+            // check the first byte to see if anything interesting is in it
+            if ( rec != nullptr && rec->decodedFlag ) {
+              // already decoded by a worker thread
+              if ( cdata[0] == 0 && cdata_size != 6145 && cdata_size != 10241 ) {
+                logger.msg(kLogInfo1, "WARNING: UNKNOWN cdata_size=%d of 0x2f chunk\n", (int)cdata_size);
+              }                
+              dbParseReplay(*rec);
             }
-            break;
+            else if ( cdata[0] != 0 ) {
+              //logger.msg(kLogInfo1, "WARNING: UNKNOWN Byte 0 of 0x2f chunk: b0=[%d 0x%02x]\n", (int)cdata[0], (int)cdata[0]);
+              dimDataList[chunkDimId]->addChunk(7, chunkX, chunkY, chunkZ, cdata, cdata_size);
+            } else {
+              if ( cdata_size != 6145 && cdata_size != 10241 ) {
+                logger.msg(kLogInfo1, "WARNING: UNKNOWN cdata_size=%d of 0x2f chunk\n", (int)cdata_size);
+              }                
+              dimDataList[chunkDimId]->addChunk(chunkFormatVersion, chunkX, chunkY, chunkZ, cdata, cdata_size);
+            }
+          }
+          break;
 
-            
-            /* 
-               todohere todonow
-               new chunk types in 0.17
-               0x2d] - size=768
-               0x2f 0x00] - size 10241
-               ...
-               0x2f 0x07] - size 10241
+        case 0x2d:
+          // "Data2D"
+          // chunk column data - 768 bytes
+          // format appears to be:
+          // 16x16 of 2-byte ints for HEIGHT OF TOP BLOCK
+          // 8x8 of 4-byte ints for BIOME and GRASS COLOR
+          // todonow todobig todohere -- this appears to be an MCPE bug, it should be 16x16, right?
+          // also - grass colors are pretty weird (some are 01 01 01)
+          
+          // todonow - would be better to get the version # from the proper chunk record (0x76)
+          if ( rec != nullptr && rec->decodedFlag ) {
+            // already decoded by a worker thread
+            dbParseReplay(*rec);
+          } else {
+            dimDataList[chunkDimId]->addChunkColumnData(3, chunkX, chunkZ, cdata, cdata_size);
+          }
+          break;
 
+          
+          /* 
+             todohere todonow
+             new chunk types in 0.17
+             0x2d] - size=768
+             0x2f 0x00] - size 10241
+             ...
+             0x2f 0x07] - size 10241
 
-               per chunk data: 2.5 bytes / block
-               block id = 1 byte
-               block data = 4-bits
-               skylight = 4-bits
-               blocklight = 4-bits
 
-               16x16x16 of this = 10,240!!
-               what is the one extra byte... hmmmm
+             per chunk data: 2.5 bytes / block
+             block id = 1 byte
+             block data = 4-bits
+             skylight = 4-bits
+             blocklight = 4-bits
 
-               NOTE! as of at least v1.1.0 there are also records that are 6145 bytes - they appear 
-               to exclude the block/sky light parts
+             16x16x16 of this = 10,240!!
+             what is the one extra byte... hmmmm
 
+             NOTE! as of at least v1.1.0 there are also records that are 6145 bytes - they appear 
+             to exclude the block/sky light parts
 
-               per column data: 5-bytes per column
-               height of top block = 1 byte
-               grass-and-biome = 4-bytes = lsb bome, high 3-bytes are RGB grass color
 
-               0x2d chunks are 768 bytes which could be column data
-               16 x 16 x 3 = 768
-               so 3 bytes per column = grass/biome + height + top block
-               could this be grass color only?
+             per column data: 5-bytes per column
+             height of top block = 1 byte
+             grass-and-biome = 4-bytes = lsb bome, high 3-bytes are RGB grass color
 
+             0x2d chunks are 768 bytes which could be column data
+             16 x 16 x 3 = 768
+             so 3 bytes per column = grass/biome + height + top block
+             could this be grass color only?
 
-               0x2f N] chunks are 10241
-               this could be 16x16 for 16 vertical blocks
-               16 of these would cover 256 build height
 
-               if blocks are 8-bits, that would be 8,192 of the size
-               which leaves 2049
-               we'd still need block data which is 4-bits per block
-               which is: 4,096 bytes.... what's going on here?!
-            */
+             0x2f N] chunks are 10241
+             this could be 16x16 for 16 vertical blocks
+             16 of these would cover 256 build height
 
-          default:
-            logger.msg(kLogInfo1,"WARNING: %s unknown chunk - key_size=%d type=0x%x length=%d\n", dimName.c_str(),
-                       (int32_t)key_size, chunkType, (int32_t)cdata_size);
-            printKeyValue(key,key_size,cdata,cdata_size,true);
+             if blocks are 8-bits, that would be 8,192 of the size
+             which leaves 2049
+             we'd still need block data which is 4-bits per block
+             which is: 4,096 bytes.... what's going on here?!
+          */
 
-            if ( false ) {
-              if ( cdata_size > 10 ) {
-                parseNbt("UNK: ", cdata, cdata_size, tagList);
-              }
-            }
-            break;
-          }
-        }
-        else {
-          logger.msg(kLogInfo1,"WARNING: Unknown chunk - key_size=%d cdata_size=%d\n", (int32_t)key_size, (int32_t)cdata_size);
+        default:
+          logger.msg(kLogInfo1,"WARNING: %s unknown chunk - key_size=%d type=0x%x length=%d\n", dimName.c_str(),
+                     (int32_t)key_size, chunkType, (int32_t)cdata_size);
           printKeyValue(key,key_size,cdata,cdata_size,true);
-          if ( false ) { 
-            // try to nbt decode
-            logger.msg(kLogInfo1,"WARNING: Attempting NBT Decode:\n");
-            parseNbt("WARNING: ", cdata, cdata_size, tagList);
+
+          if ( false ) {
+            if ( cdata_size > 10 ) {
+              parseNbt("UNK: ", cdata, cdata_size, tagList);
+            }
           }
+          break;
         }
       }
-      slogger.msg(kLogInfo1,"Read %d records\n", recordCt);
-      slogger.msg(kLogInfo1,"Status: %s\n", iter->status().ToString().c_str());
-      
-      if (!iter->status().ok()) {
-        slogger.msg(kLogInfo1,"WARNING: LevelDB operation returned status=%s\n",iter->status().ToString().c_str());
+      else {
+        logger.msg(kLogInfo1,"WARNING: Unknown chunk - key_size=%d cdata_size=%d\n", (int32_t)key_size, (int32_t)cdata_size);
+        printKeyValue(key,key_size,cdata,cdata_size,true);
+        if ( false ) { 
+          // try to nbt decode
+          logger.msg(kLogInfo1,"WARNING: Attempting NBT Decode:\n");
+          parseNbt("WARNING: ", cdata, cdata_size, tagList);
+        }
       }
-      delete iter;
-
       return 0;
     }
 
@@ -4861,7 +7077,33 @@ namespace mcpe_viz {
       return 0;
     }
 
-    int32_t doOutput_Tile_image(const std::string& fn) {
+    // --chunk-cache: get the tiles that have pixels from chunks that changed since the last run
+    // returns false if all tiles need to be made
+    bool getDirtyTiles(int32_t dimId, TileSet& tiles) {
+      std::vector< std::pair<int32_t, int32_t> > changed;
+      tiles.clear();
+      if ( ! control.chunkCacheFlag || ! chunkCache.getChangedChunks(dimId, changed) ) {
+        return false;
+      }
+
+      const int32_t minChunkX = dimDataList[dimId]->getMinChunkX();
+      const int32_t minChunkZ = dimDataList[dimId]->getMinChunkZ();
+      for ( const auto& it : changed ) {
+        // note: we add a pixel on each side because the shaded relief image uses the neighboring pixels
+        int32_t x1 = std::max(0, (it.first - minChunkX) * 16 - 1);
+        int32_t x2 = (it.first - minChunkX) * 16 + 16;
+        int32_t y1 = std::max(0, (it.second - minChunkZ) * 16 - 1);
+        int32_t y2 = (it.second - minChunkZ) * 16 + 16;
+        for (int32_t ty = y1 / control.tileHeight; ty <= y2 / control.tileHeight; ty++) {
+          for (int32_t tx = x1 / control.tileWidth; tx <= x2 / control.tileWidth; tx++) {
+            tiles.insert( std::make_pair(ty, tx) );
+          }
+        }
+      }
+      return true;
+    }
+    
+    int32_t doOutput_Tile_image(const std::string& fn, const TileSet* dirtyTiles) {
       if ( fn.size() <= 0 ) {
         return -1;
       }
@@ -4871,10 +7113,15 @@ namespace mcpe_viz {
 
       slogger.msg(kLogInfo1,"Creating tiles for %s...\n", mybasename(fn).c_str());
       PngTiler pngTiler(fn, control.tileWidth, control.tileHeight, dirOut);
+      pngTiler.setDirtyTiles(dirtyTiles);
       if ( pngTiler.doTile() == 0 ) {
         // all is good
+        if ( dirtyTiles != nullptr ) {
+          slogger.msg(kLogInfo1,"  Wrote %d tiles, %d tiles unchanged\n", pngTiler.writeCt, pngTiler.skipCt);
+        }
       } else {
-        // todobig - error
+        slogger.msg(kLogInfo1,"ERROR: Failed to create tiles for %s\n", mybasename(fn).c_str());
+        return -1;
       }
 
       return 0;
@@ -4885,21 +7132,37 @@ namespace mcpe_viz {
         return 0;
       }
 
+      // note: the images are tiled at the same time with --threads
+      OutputTaskList tasks;
       for (int32_t dimid=0; dimid < kDimIdCount; dimid++) {
-        doOutput_Tile_image(control.fnLayerTop[dimid]);
-        doOutput_Tile_image(control.fnLayerBiome[dimid]);
-        doOutput_Tile_image(control.fnLayerHeight[dimid]);
-        doOutput_Tile_image(control.fnLayerHeightGrayscale[dimid]);
-        doOutput_Tile_image(control.fnLayerHeightAlpha[dimid]);
-        doOutput_Tile_image(control.fnLayerBlockLight[dimid]);
-        doOutput_Tile_image(control.fnLayerSkyLight[dimid]);
-        doOutput_Tile_image(control.fnLayerSlimeChunks[dimid]);
-        doOutput_Tile_image(control.fnLayerGrass[dimid]);
-        doOutput_Tile_image(control.fnLayerShadedRelief[dimid]);
+        const TileSet* dirtyTiles = dirtyTileListValid[dimid] ? &dirtyTileList[dimid] : nullptr;
+
+        std::vector<std::string> fnList;
+        // note: with --direct-tiles we already wrote the tiles for everything except the slices
+        if ( ! control.useDirectTiles() ) {
+          fnList = {
+            control.fnLayerTop[dimid],
+            control.fnLayerBiome[dimid],
+            control.fnLayerHeight[dimid],
+            control.fnLayerHeightGrayscale[dimid],
+            control.fnLayerHeightAlpha[dimid],
+            control.fnLayerBlockLight[dimid],
+            control.fnLayerSkyLight[dimid],
+            control.fnLayerSlimeChunks[dimid],
+            control.fnLayerGrass[dimid],
+            control.fnLayerShadedRelief[dimid]
+          };
+        }
         for (int32_t cy=0; cy <= MAX_BLOCK_HEIGHT; cy++) {
-          doOutput_Tile_image(control.fnLayerRaw[dimid][cy]);
+          fnList.push_back(control.fnLayerRaw[dimid][cy]);
+        }
+        for ( const auto& fn : fnList ) {
+          if ( fn.size() > 0 ) {
+            tasks.add([this,fn,dirtyTiles]() { doOutput_Tile_image(fn, dirtyTiles); });
+          }
         }
       }
+      tasks.run(control.threadCount);
 
       return 0;
     }
@@ -4911,7 +7174,7 @@ namespace mcpe_viz {
         return "images/" + ret;
       }
       if ( ret.size() > 1 ) {
-        return "tiles/" + ret + ".{y}.{x}.png";
+        return "tiles/{z}/" + ret + ".{y}.{x}.png";
       }
       return "";
     }
@@ -4975,6 +7238,7 @@ namespace mcpe_viz {
                 "var creationMcpeVizVersion = '%s';\n"
                 "var loadGeoJSONFlag = %s;\n"
                 "var fnGeoJSON = '%s';\n"
+                "var fnGeoJSONBin = '%s';\n"
                 "var useTilesFlag = %s;\n"
                 "var tileW = %d;\n"
                 "var tileH = %d;\n"
@@ -4985,6 +7249,7 @@ namespace mcpe_viz {
                 , mcpe_viz_version_short.c_str()
                 , control.noForceGeoJSONFlag ? "true" : "false"
                 , mybasename(control.fnGeoJSON).c_str()
+                , mybasename(control.fnGeoJSONBin).c_str()
                 , control.doTiles ? "true" : "false"
                 , control.tileWidth
                 , control.tileHeight
@@ -5026,6 +7291,16 @@ namespace mcpe_viz {
           fprintf(fp," ],\n");
           
           fprintf(fp,"  spawnableFlag: %s,\n", ( dimDataList[did]->listCheckSpawn.size() > 0 ) ? "true" : "false");
+
+          // number of zoom levels in the tile pyramid
+          const int32_t imageW = (dimDataList[did]->getMaxChunkX() - dimDataList[did]->getMinChunkX() + 1) * 16;
+          const int32_t imageH = (dimDataList[did]->getMaxChunkZ() - dimDataList[did]->getMinChunkZ() + 1) * 16;
+          fprintf(fp,"  tileLevelCount: %d,\n", getTileLevelCount(imageW, imageH, control.tileWidth, control.tileHeight));
+          if ( control.useFeatureTiles() ) {
+            fprintf(fp,"  fnFeatureTiles: 'features/%s.%d',\n", mybasename(control.fnOutputBase).c_str(), did);
+          } else {
+            fprintf(fp,"  fnFeatureTiles: '',\n");
+          }
           
           fprintf(fp,"  fnLayerTop: '%s',\n", makeTileURL(control.fnLayerTop[did]).c_str());
           fprintf(fp,"  fnLayerBiome: '%s',\n", makeTileURL(control.fnLayerBiome[did]).c_str());
@@ -5226,92 +7501,186 @@ namespace mcpe_viz {
 
 
     int32_t doOutput_GeoJSON() {
+      FILE* fpGeoJSON = fopen(control.fnGeoJSON.c_str(), "w");
+      if ( ! fpGeoJSON ) {
+        slogger.msg(kLogInfo1,"ERROR: Failed to create GeoJSON output file (%s error=%s (%d)).\n", control.fnGeoJSON.c_str(), strerror(errno), errno);
+        return -1;
+      }
 
-      if ( false ) { 
-#if 0
-        // todobig - this would be lovely but does not work when run on windows (browser does not like the gzip'ed geojson file)
-        
-        // we output gzip'ed data (saves a ton of disk+bandwidth for very little cost)
-        
-        gzFile_s* fpGeoJSON = gzopen(control.fnGeoJSON.c_str(), "w");
-        if ( ! fpGeoJSON ) {
-          slogger.msg(kLogInfo1,"ERROR: Failed to create GeoJSON output file (%s).\n", control.fnGeoJSON.c_str());
-          return -1;
+      // --geojson-compact: we also put a gzip'ed copy for web servers that can send it with "Content-Encoding: gzip"
+      // note: we always put the plain file because browsers do not like the gzip'ed file when it is loaded from file://
+      gzFile fpGeoJSONGz = nullptr;
+      if ( control.geojsonCompactFlag ) {
+        fpGeoJSONGz = gzopen(control.fnGeoJSONGz.c_str(), "wb");
+        if ( fpGeoJSONGz ) {
+          // todo - param for buffer size?
+          gzbuffer(fpGeoJSONGz, 256 * 1024);
+        } else {
+          slogger.msg(kLogInfo1,"ERROR: Failed to create GeoJSON output file (%s).\n", control.fnGeoJSONGz.c_str());
         }
-        
-        // set params for gzip
-        //gzsetparams(fpGeoJSON, Z_BEST_COMPRESSION, Z_DEFAULT_STRATEGY);
-        
-        // put the geojson preamble stuff
-        if ( ! control.noForceGeoJSONFlag ) {
-          gzprintf(fpGeoJSON, "var geojson =\n" );
-        }
-        gzprintf(fpGeoJSON,
-                 "{ \"type\": \"FeatureCollection\",\n"
-                 // todo - correct way to specify this?
-                 "\"crs\": { \"type\": \"name\", \"properties\": { \"name\": \"mcpe_viz-image\" } },\n"
-                 "\"features\": [\n"
-                 );
-
-        // put the list with correct commas (silly)
-        int32_t i = listGeoJSON.size();
-        for ( const auto& it: listGeoJSON ) {
-          gzputs(fpGeoJSON, it.c_str());
+      }
+
+      bool okFlag = true;
+      auto put = [&](const char* p, size_t len) {
+        if ( len == 0 ) {
+          return;
+        }
+        if ( fwrite(p, len, 1, fpGeoJSON) != 1 ) {
+          okFlag = false;
+        }
+        if ( fpGeoJSONGz && gzwrite(fpGeoJSONGz, p, len) != (int)len ) {
+          okFlag = false;
+        }
+      };
+      auto putString = [&](const std::string& str) {
+        put(str.data(), str.size());
+      };
+
+      // put the geojson preamble stuff
+      if ( ! control.noForceGeoJSONFlag ) {
+        putString("var geojson =\n");
+      }
+      if ( control.geojsonCompactFlag ) {
+        putString("{\"type\":\"FeatureCollection\","
+                  "\"crs\":{\"type\":\"name\",\"properties\":{\"name\":\"mcpe_viz-image\"}},"
+                  "\"features\":[\n");
+      } else {
+        putString("{ \"type\": \"FeatureCollection\",\n"
+                  // todo - correct way to specify this?
+                  "\"crs\": { \"type\": \"name\", \"properties\": { \"name\": \"mcpe_viz-image\" } },\n"
+                  "\"features\": [\n");
+      }
+
+      // put the list with correct commas (silly)
+      std::string compactBuf;
+      int64_t i = geojsonSink.size();
+      geojsonSink.forEach([&](const std::string& it) {
+          if ( control.geojsonCompactFlag ) {
+            compactJson(it, compactBuf);
+            putString(compactBuf);
+          } else {
+            putString(it);
+          }
           if ( --i > 0 ) {
-            gzputc(fpGeoJSON,',');
+            put(",\n", 2);
+          } else {
+            put("\n", 1);
           }
-          gzputc(fpGeoJSON,'\n');
-        }
+        });
 
-        // close out the geojson properly
-        if ( control.noForceGeoJSONFlag ) {
-          gzprintf(fpGeoJSON,"] }\n");
-        } else {
-          gzprintf(fpGeoJSON,"] };\n");
-        }
-          
-        gzclose(fpGeoJSON);
-#endif
+      // close out the geojson properly
+      if ( control.noForceGeoJSONFlag ) {
+        putString("] }\n");
       } else {
+        putString("] };\n");
+      }
 
-        // plain text file version
-        
-        FILE* fpGeoJSON = fopen(control.fnGeoJSON.c_str(), "w");
-        if ( ! fpGeoJSON ) {
-          slogger.msg(kLogInfo1,"ERROR: Failed to create GeoJSON output file (%s error=%s (%d)).\n", control.fnGeoJSON.c_str(), strerror(errno), errno);
-          return -1;
-        }
+      if ( fclose(fpGeoJSON) != 0 ) {
+        okFlag = false;
+      }
+      if ( fpGeoJSONGz && gzclose(fpGeoJSONGz) != Z_OK ) {
+        okFlag = false;
+      }
+      if ( ! okFlag ) {
+        slogger.msg(kLogInfo1,"ERROR: Failed to write GeoJSON output file (%s).\n", control.fnGeoJSON.c_str());
+      }
+
+      if ( control.noForceGeoJSONFlag ) {
+        doOutput_GeoJSONBin();
+      }
+      return 0;
+    }
 
-        // put the geojson preamble stuff
-        if ( ! control.noForceGeoJSONFlag ) {
-          fprintf(fpGeoJSON, "var geojson =\n" );
+    // compact columnar copy of the features -- the web app uses this when it can fetch files (see loadVectors)
+    // note: only with --no-force-geojson
+    int32_t doOutput_GeoJSONBin() {
+      GeoJsonColumns columns;
+      geojsonSink.forEach([&](const std::string& it) {
+          columns.add(it);
+        });
+      if ( columns.errorCt > 0 ) {
+        // note: we remove the files from a previous run so that the web app uses the geojson file instead
+        slogger.msg(kLogInfo1,"ERROR: %d geojson items could not be put in the binary feature file -- it will not be written\n", columns.errorCt);
+        deleteFile(control.fnGeoJSONBin);
+        if ( control.useFeatureTiles() ) {
+          doOutput_FeatureTiles(columns, true);
         }
-        fprintf(fpGeoJSON,
-                "{ \"type\": \"FeatureCollection\",\n"
-                // todo - correct way to specify this?
-                "\"crs\": { \"type\": \"name\", \"properties\": { \"name\": \"mcpe_viz-image\" } },\n"
-                "\"features\": [\n"
-                );
+        return -1;
+      }
+      if ( columns.write(control.fnGeoJSONBin) != 0 ) {
+        slogger.msg(kLogInfo1,"ERROR: Failed to create binary feature file (%s error=%s (%d)).\n", control.fnGeoJSONBin.c_str(), strerror(errno), errno);
+        return -1;
+      }
+      slogger.msg(kLogInfo1,"  Binary feature file: %d features, %d strings\n", (int32_t)columns.size(), (int32_t)columns.stringList.size());
 
-        // put the list with correct commas (silly)
-        int32_t i = listGeoJSON.size();
-        for ( const auto& it: listGeoJSON ) {
-          fputs(it.c_str(), fpGeoJSON);
-          if ( --i > 0 ) {
-            fputc(',',fpGeoJSON);
+      if ( control.useFeatureTiles() ) {
+        doOutput_FeatureTiles(columns, false);
+      }
+      return 0;
+    }
+
+    // split the features into tiles that line up with the full resolution image tiles
+    // note: we put every tile in the grid (even empty ones) so that tiles from a previous run are replaced
+    // note: with removeFlag we only remove the tiles (the web app then uses the single feature file)
+    int32_t doOutput_FeatureTiles(const GeoJsonColumns& columns, bool removeFlag) {
+      std::string dirOut = mydirname(control.fnOutputBase) + "/features";
+      local_mkdir(dirOut.c_str());
+      std::string fnBase = mybasename(control.fnOutputBase);
+
+      int32_t writeCt = 0, errorCt = 0;
+      std::string fnFirstError;
+      int32_t firstErrno = 0;
+      for (int32_t did=0; did < kDimIdCount; did++) {
+        const int32_t imageW = (dimDataList[did]->getMaxChunkX() - dimDataList[did]->getMinChunkX() + 1) * 16;
+        const int32_t imageH = (dimDataList[did]->getMaxChunkZ() - dimDataList[did]->getMinChunkZ() + 1) * 16;
+        const int32_t tileCols = (imageW + control.tileWidth - 1) / control.tileWidth;
+        const int32_t tileRows = (imageH + control.tileHeight - 1) / control.tileHeight;
+
+        // note: we only keep the feature indices for each tile -- the tiles are written straight from the shared columns
+        std::vector< std::vector<uint32_t> > tiles(tileCols * tileRows);
+        for (size_t i=0; i < columns.size() && ! removeFlag; i++) {
+          // hack for pre-0.12 worlds (no dimension) -- same as the web app
+          int32_t fdid = std::max(0, (int32_t)columns.dimId[i]);
+          if ( fdid != did ) {
+            continue;
+          }
+          // note: geojson y is flipped (0 is the bottom of the image); items outside the image go in the edge tiles
+          const float* pt = &columns.coords[columns.pointStart[i] * 2];
+          int32_t col = (int32_t)floor(pt[0] / control.tileWidth);
+          int32_t row = (int32_t)floor((imageH - 1 - pt[1]) / control.tileHeight);
+          col = std::min(std::max(col, 0), tileCols - 1);
+          row = std::min(std::max(row, 0), tileRows - 1);
+          tiles[row * tileCols + col].push_back((uint32_t)i);
+        }
+
+        char tmpstring[1025];
+        for (int32_t row=0; row < tileRows; row++) {
+          for (int32_t col=0; col < tileCols; col++) {
+            sprintf(tmpstring, "%s/%s.%d.%d.%d.bin", dirOut.c_str(), fnBase.c_str(), did, row, col);
+            if ( removeFlag ) {
+              deleteFile(tmpstring);
+              continue;
+            }
+            std::vector<uint32_t>& tile = tiles[row * tileCols + col];
+            if ( columns.writeSubset(tmpstring, tile) == 0 ) {
+              writeCt++;
+            } else {
+              if ( errorCt++ == 0 ) {
+                fnFirstError = tmpstring;
+                firstErrno = errno;
+              }
+            }
+            std::vector<uint32_t>().swap(tile);
           }
-          fputc('\n',fpGeoJSON);
         }
+      }
 
-        // close out the geojson properly
-        if ( control.noForceGeoJSONFlag ) {
-          fprintf(fpGeoJSON,"] }\n");
-        } else {
-          fprintf(fpGeoJSON,"] };\n");
-        }
-          
-        fclose(fpGeoJSON);
-        
+      if ( errorCt > 0 ) {
+        slogger.msg(kLogInfo1,"ERROR: Failed to create %d feature tiles in %s (first: %s error=%s (%d))\n"
+                    , errorCt, dirOut.c_str(), fnFirstError.c_str(), strerror(firstErrno), firstErrno);
+      }
+      if ( ! removeFlag ) {
+        slogger.msg(kLogInfo1,"  Feature tiles: %d\n", writeCt);
       }
       return 0;
     }
@@ -5321,13 +7690,9 @@ namespace mcpe_viz {
       calcChunkBounds();
 
       // todonow todobig todostopper -- how to handle worlds that are larger than png dimensional limits (see midgard world file)
-      
-      for (int32_t i=0; i < kDimIdCount; i++) {
-        dimDataList[i]->doOutput(db);
-      }
 
+      // note: we decide about tiles before we make the images because of --direct-tiles
       if ( control.doHtml ) {
-
         if ( control.autoTileFlag ) {
           int32_t xdimId = kDimIdOverworld;
           const int32_t chunkW = (dimDataList[xdimId]->getMaxChunkX() - dimDataList[xdimId]->getMinChunkX() + 1);
@@ -5342,15 +7707,36 @@ namespace mcpe_viz {
             control.doTiles = true;
           }
         }
+      }
+
+      for (int32_t i=0; i < kDimIdCount; i++) {
+        dirtyTileListValid[i] = getDirtyTiles(i, dirtyTileList[i]);
+        dimDataList[i]->setDirtyTiles( dirtyTileListValid[i] ? &dirtyTileList[i] : nullptr );
+      }
+      
+      // note: with --threads the images of both dimensions are made at the same time
+      OutputTaskList tasks;
+      for (int32_t i=0; i < kDimIdCount; i++) {
+        dimDataList[i]->addOutputTasks(db, tasks);
+      }
+      tasks.run(control.threadCount);
 
+      if ( control.doHtml ) {
         doOutput_Tile();
         doOutput_html();
         doOutput_GeoJSON();
+        // note: this removes the geojson spool file
+        geojsonSink.close();
       }
         
       if ( control.colorTestFlag ) {
         doOutput_colortest();
       }
+
+      // note: we save the chunk cache last so that the next run will redo the tiles if we did not finish
+      if ( control.chunkCacheFlag ) {
+        chunkCache.save(control.fnChunkCache);
+      }
         
       return 0;
     }
@@ -5815,7 +8201,8 @@ namespace mcpe_viz {
                 "  --html-all               Create html, javascript, and *all* image files to use as a fancy viewer\n"
                 //"  --dir-temp dir           Directory for temp files (useful for --slices, use a fast, local directory)\n"
                 "  --auto-tile              Automatically tile the images if they are very large\n"
-                "  --tiles[=tilew,tileh]    Create tiles in subdirectory tiles/ (useful for LARGE worlds)\n"
+                "  --tiles[=tilew,tileh]    Create tiles (with zoom levels) in subdirectory tiles/ (useful for LARGE worlds)\n"
+                "  --direct-tiles           Write tiles as the images are made instead of making full-size images (except slices) (implies --tiles)\n"
                 "\n"
                 "  --hide-top=did,bid       Hide a block from top block (did=dimension id, bid=block id)\n"
                 "  --force-top=did,bid      Force a block to top block (did=dimension id, bid=block id)\n"
@@ -5845,7 +8232,13 @@ namespace mcpe_viz {
                 "  --xml fn                 XML file containing data definitions\n"
                 "  --log fn                 Send log to a file\n"
                 "\n"
+                "  --threads n              Use n threads to read and decode the world and to make the images (output is the same as with one thread)\n"
+                "  --single-pass            Don't pre-scan the world for its bounds (less i/o; no image coords in log file)\n"
+                "  --chunk-cache            Only decode chunks (and write tiles) that changed since the last run (uses (outputname).chunkcache and .chunkcache.geojson)\n"
+                "  --top-only               Only decode the sub-chunks that hold the top blocks (much faster; block counts only cover those sub-chunks)\n"
+                "\n"
                 "  --no-force-geojson       Don't load geojson in html because we are going to use a web server (or Firefox)\n"
+                "  --geojson-compact        Write compact geojson (no whitespace; short numbers) and a gzip'ed copy (.geojson.gz)\n"
                 "\n"
                 "  --verbose                verbose output\n"
                 "  --quiet                  supress normal output, continue to output warning and error messages\n"
@@ -5914,18 +8307,27 @@ namespace mcpe_viz {
                                           {"html-most", no_argument, NULL, '='},
                                           {"html-all", no_argument, NULL, '_'},
                                           {"no-force-geojson", no_argument, NULL, ':'},
+                                          {"geojson-compact", no_argument, NULL, 'j'},
 
                                           {"auto-tile", no_argument, NULL, ']'},
                                           {"tiles", optional_argument, NULL, '['},
+                                          {"direct-tiles", no_argument, NULL, 'W'},
 
                                           {"shortrun", no_argument, NULL, '$'}, // this is just for testing
                                           {"colortest", no_argument, NULL, '!'}, // this is just for testing
+                                          {"bench-uname", no_argument, NULL, 'Y'}, // this is just for testing
+                                          {"bench-format", no_argument, NULL, 'y'}, // this is just for testing
 
                                           {"flush", no_argument, NULL, 'f'},
 
                                           {"leveldb-filter", required_argument, NULL, '<'},
                                           {"leveldb-block-size", required_argument, NULL, '>'},
 
+                                          {"threads", required_argument, NULL, 'T'},
+                                          {"single-pass", no_argument, NULL, 'P'},
+                                          {"chunk-cache", no_argument, NULL, 'K'},
+                                          {"top-only", no_argument, NULL, 'N'},
+
                                           {"find-images", required_argument, NULL, '"'},
       
                                           {"verbose", no_argument, NULL, 'v'},
@@ -5974,6 +8376,25 @@ namespace mcpe_viz {
         }
         break;
 
+      case 'T':
+        control.threadCount = atoi(optarg);
+        if ( control.threadCount < 1 ) {
+          control.threadCount = 1;
+        }
+        break;
+      case 'P':
+        control.singlePassFlag = true;
+        break;
+      case 'K':
+        control.chunkCacheFlag = true;
+        break;
+      case 'N':
+        control.topOnlyFlag = true;
+        break;
+      case 'j':
+        control.geojsonCompactFlag = true;
+        break;
+
       case '"':
         control.doFindImages = true;
         // todobig - specify an in and an out dir
@@ -6151,6 +8572,10 @@ namespace mcpe_viz {
       case ']':
         control.autoTileFlag = true;
         break;
+      case 'W':
+        control.doTiles = true;
+        control.directTilesFlag = true;
+        break;
         
       case '=':
         // html most
@@ -6250,6 +8675,12 @@ namespace mcpe_viz {
       case '!':
         control.colorTestFlag = true;
         break;
+      case 'Y':
+        control.benchUnameFlag = true;
+        break;
+      case 'y':
+        control.benchFormatFlag = true;
+        break;
       
       case 'v': 
         control.verboseFlag = true; 
@@ -6289,7 +8720,9 @@ namespace mcpe_viz {
     }
     
     if ( errct <= 0 ) {
-      control.setupOutput();
+      if ( control.setupOutput() != 0 ) {
+        errct++;
+      }
     }
     
     return errct;
@@ -6318,6 +8751,8 @@ namespace mcpe_viz {
       return -1;
     }
     
+    buildUnameIndex();
+    
     parseConfigFile();
     
     makePalettes();
@@ -6342,6 +8777,14 @@ int main ( int argc, char **argv ) {
     mcpe_viz::findImages();
     return 0;
   }
+
+  if ( mcpe_viz::control.benchUnameFlag ) {
+    return mcpe_viz::benchUnameLookup();
+  }
+
+  if ( mcpe_viz::control.benchFormatFlag ) {
+    return mcpe_viz::benchNumberFormat();
+  }
   
   mcpe_viz::world->init();
 
@@ -23,7 +23,10 @@ namespace mcpe_viz {
   extern Logger logger;
   extern double playerPositionImageX, playerPositionImageY;
   extern int32_t playerPositionDimensionId;
-  extern std::vector<std::string> listGeoJSON;
+  extern double playerPositionWorldX, playerPositionWorldZ;
+  // this is set while dbParse runs in single-pass mode (image coordinates are not known until the parse is done)
+  extern bool deferImageCoordsFlag;
+  extern GeoJsonSink geojsonSink;
 
   extern int32_t globalIconImageId;
   
@@ -51,7 +54,6 @@ namespace mcpe_viz {
     bool opaqueFlag;
     bool liquidFlag;
     bool spawnableFlag;
-    int32_t colorSetNeedCount;
     int32_t blockdata;
     std::vector< std::unique_ptr<BlockInfo> > variantList;
     bool valid;
@@ -69,7 +71,6 @@ namespace mcpe_viz {
       liquidFlag = false;
       spawnableFlag = true;
       colorSetFlag = false;
-      colorSetNeedCount = 0;
       variantList.clear();
       valid = false;
       userVar1 = 0;
@@ -180,6 +181,7 @@ namespace mcpe_viz {
   std::string getBlockName(int32_t id, int32_t blockdata);
 
   int32_t getBlockByUname(const std::string& uname, int32_t& blockId, int32_t& blockData);
+  int32_t getBlockByUname_quiet(const std::string& uname, int32_t& blockId, int32_t& blockData);
   
 
   class ItemInfo {
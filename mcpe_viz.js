@@ -1847,6 +1847,21 @@ function doSlimeChunks(enabled) {
     }
 }
 
+// tiles are a pyramid: zoom level 0 fits in one tile, the last zoom level is full resolution
+function makeTileGrid() {
+    var levelCount = dimensionInfo[globalDimensionId].tileLevelCount || 1;
+    var resolutions = [];
+    for (var z = 0; z < levelCount; z++) {
+        resolutions.push(Math.pow(2, levelCount - 1 - z));
+    }
+    return new ol.tilegrid.TileGrid({
+        extent: extent,
+        minZoom: 0,
+        tileSize: [ tileW, tileH ],
+        resolutions: resolutions
+    });
+}
+
 function setLayer(fn, extraHelp) {
     if (fn.length <= 1) {
         if ( extraHelp === undefined ) {
@@ -1871,15 +1886,7 @@ function setLayer(fn, extraHelp) {
             projection: projection,
             //wrapX: false,
             tileSize: [ tileW, tileH ],
-            tileGrid: new ol.tilegrid.TileGrid({
-                //extent: [ 0, 0, 39, 25 ],
-                extent: extent,
-                minZoom: 0,
-                // todobig - should this be 0?
-                maxZoom: 1,
-                tileSize: [ tileW, tileH ],
-                resolutions: [ 1 ]
-            })
+            tileGrid: makeTileGrid()
             //imageSize: [dimensionInfo[globalDimensionId].worldWidth, dimensionInfo[globalDimensionId].worldHeight],
             // 'Extent of the image in map coordinates. This is the [left, bottom, right, top] map coordinates of your image.'
             //imageExtent: extent
@@ -2140,6 +2147,11 @@ function initDimension() {
         map.setView(view);
     }
 
+    // feature tiles are per-dimension
+    if ( vectorPoints !== null && useFeatureTiles() ) {
+        vectorPoints.setSource(createFeatureTileSource());
+    }
+
     // setup per-dimension block select menu
 
     // todobig - clear selected items?
@@ -2440,10 +2452,267 @@ var villageCreatePointStyleFunction = function() {
 
 
 var vectorPoints = null;
+// when more than this many feature tiles are in view we load the single feature file instead
+var featureTileMaxInView = 64;
+var featureFileSource = null;
+// set when a feature tile can't be loaded (e.g. mcpe_viz removed them) -- we then stay with the single feature file
+var featureTileErrorFlag = false;
 var villageVectorPoints = null;
 var srcVillageVectorPoints = null;
 var featuresVillageVectorPoints = new ol.Collection();
 
+// decode the compact binary version of the features (see GeoJsonColumns in mcpe_viz.util.h)
+function decodeFeatureBinary(buf) {
+    var header = new Uint32Array(buf, 0, 7);
+    var magic = String.fromCharCode.apply(null, new Uint8Array(buf, 0, 4));
+    if ( magic !== 'MVZF' || header[1] !== 1 ) {
+        throw new Error('Unknown binary feature file format');
+    }
+    var featureCount = header[2], pointCount = header[3], propCount = header[4];
+    var stringCount = header[5], stringBytes = header[6];
+
+    // sections are padded to 4 bytes
+    var offset = 7 * 4;
+    var section = function(ArrayType, count) {
+        var a = new ArrayType(buf, offset, count);
+        offset += (count * ArrayType.BYTES_PER_ELEMENT + 3) & ~3;
+        return a;
+    };
+    var pointStart = section(Uint32Array, featureCount + 1);
+    var coords = section(Float32Array, pointCount * 2);
+    var propStart = section(Uint32Array, featureCount + 1);
+    var propKey = section(Uint32Array, propCount);
+    var propValue = section(Uint32Array, propCount);
+    section(Uint32Array, featureCount); // typeId
+    var geomType = section(Uint8Array, featureCount);
+    section(Int8Array, featureCount); // dimId
+    var stringStart = section(Uint32Array, stringCount + 1);
+    var stringData = section(Uint8Array, stringBytes);
+
+    // the strings are raw json -- we parse each one once, except objects and arrays (so features do not share them)
+    var decoder = (typeof TextDecoder !== 'undefined') ? new TextDecoder('utf-8') : null;
+    var stringText = new Array(stringCount);
+    var stringValue = new Array(stringCount);
+    var getValue = function(i) {
+        if ( stringText[i] === undefined ) {
+            var bytes = stringData.subarray(stringStart[i], stringStart[i + 1]);
+            if ( decoder ) {
+                stringText[i] = decoder.decode(bytes);
+            } else {
+                stringText[i] = decodeURIComponent(escape(String.fromCharCode.apply(null, bytes)));
+            }
+        }
+        var c = stringText[i].charAt(0);
+        if ( c === '{' || c === '[' ) {
+            return JSON.parse(stringText[i]);
+        }
+        if ( stringValue[i] === undefined ) {
+            stringValue[i] = JSON.parse(stringText[i]);
+        }
+        return stringValue[i];
+    };
+
+    var features = new Array(featureCount);
+    for (var i = 0; i < featureCount; i++) {
+        var props = {};
+        for (var j = propStart[i]; j < propStart[i + 1]; j++) {
+            props[getValue(propKey[j])] = getValue(propValue[j]);
+        }
+        var geom;
+        if ( geomType[i] === 1 ) {
+            var coordList = [];
+            for (var k = pointStart[i]; k < pointStart[i + 1]; k++) {
+                coordList.push([coords[k * 2], coords[k * 2 + 1]]);
+            }
+            geom = new ol.geom.MultiPoint(coordList);
+        } else {
+            var p = pointStart[i];
+            geom = new ol.geom.Point([coords[p * 2], coords[p * 2 + 1]]);
+        }
+        var feature = new ol.Feature(props);
+        feature.setGeometry(geom);
+        features[i] = feature;
+    }
+    return features;
+}
+
+function loadVectorsGeoJSON(src) {
+    $.ajax({
+        type: 'GET',
+        url: fnGeoJSON,
+        dataType: 'text',
+        success: function(result, textStatus, jqxhr) {
+            var format = new ol.format.GeoJSON();
+            src.addFeatures(format.readFeatures(result, {featureProjection: projection}));
+        },
+        error: function(jqXHR, textStatus, errorThrown, execptionObject) {
+            updateLoadEventCount(-1);
+            doModal('Image Load Error',
+                    'Could not load file: ' + fnGeoJSON + '<br/>' +
+                    globalCORSWarning);
+        }
+    });
+}
+
+function loadVectorsBinary(src) {
+    // note: jquery (1.x) can't get an arraybuffer
+    var xhr = new XMLHttpRequest();
+    xhr.open('GET', fnGeoJSONBin, true);
+    xhr.responseType = 'arraybuffer';
+    xhr.onload = function() {
+        var features = null;
+        if ( xhr.status === 200 || xhr.status === 0 ) {
+            try {
+                features = decodeFeatureBinary(xhr.response);
+            } catch (e) {
+                features = null;
+            }
+        }
+        if ( features === null ) {
+            // fall back to the geojson file
+            loadVectorsGeoJSON(src);
+            return;
+        }
+        src.addFeatures(features);
+    };
+    xhr.onerror = function() {
+        loadVectorsGeoJSON(src);
+    };
+    xhr.send();
+}
+
+function useFeatureTiles() {
+    return loadGeoJSONFlag && useTilesFlag && ! featureTileErrorFlag &&
+        dimensionInfo[globalDimensionId].fnFeatureTiles !== undefined &&
+        dimensionInfo[globalDimensionId].fnFeatureTiles !== '';
+}
+
+// features are split into tiles that line up with the full resolution image tiles (see doOutput_FeatureTiles in mcpe_viz.cc)
+// we only get the tiles that are in view -- when zoomed out too far we switch to the single feature file (see useFeatureFile)
+function createFeatureTileSource() {
+    var fnBase = dimensionInfo[globalDimensionId].fnFeatureTiles;
+    var gridExtent = extent;
+    var tileCols = Math.ceil((gridExtent[2] - gridExtent[0]) / tileW);
+    var tileRows = Math.ceil((gridExtent[3] - gridExtent[1]) / tileH);
+    var src = new ol.source.Vector({
+        // note: the tiles are the same at every zoom level, so we work out the tiles in view ourselves
+        strategy: function(viewExtent, resolution) {
+            var minCol = Math.max(0, Math.floor((viewExtent[0] - gridExtent[0]) / tileW));
+            var maxCol = Math.min(tileCols - 1, Math.floor((viewExtent[2] - gridExtent[0]) / tileW));
+            var minRow = Math.max(0, Math.floor((gridExtent[3] - viewExtent[3]) / tileH));
+            var maxRow = Math.min(tileRows - 1, Math.floor((gridExtent[3] - viewExtent[1]) / tileH));
+            if ( (maxCol - minCol + 1) * (maxRow - minRow + 1) > featureTileMaxInView ) {
+                // note: we switch sources once OpenLayers is done with this call
+                setTimeout(useFeatureFile, 0);
+                return [];
+            }
+            var extents = [];
+            for (var row = minRow; row <= maxRow; row++) {
+                for (var col = minCol; col <= maxCol; col++) {
+                    extents.push([ gridExtent[0] + col * tileW, gridExtent[3] - (row + 1) * tileH,
+                                   gridExtent[0] + (col + 1) * tileW, gridExtent[3] - row * tileH ]);
+                }
+            }
+            return extents;
+        },
+        loader: function(tileExtent, resolution, proj) {
+            // note: the tile grid origin is the top left of the extent
+            var col = Math.round((tileExtent[0] - gridExtent[0]) / tileW);
+            var row = Math.round((gridExtent[3] - tileExtent[3]) / tileH);
+            var url = fnBase + '.' + row + '.' + col + '.bin';
+            var xhr = new XMLHttpRequest();
+            xhr.open('GET', url, true);
+            xhr.responseType = 'arraybuffer';
+            xhr.onload = function() {
+                updateLoadEventCount(-1);
+                if ( xhr.status === 200 || xhr.status === 0 ) {
+                    try {
+                        src.addFeatures(decodeFeatureBinary(xhr.response));
+                        return;
+                    } catch (e) {
+                        console.log('Failed to load feature tile ' + url + ': ' + e.toString());
+                    }
+                }
+                onFeatureTileError(url);
+            };
+            xhr.onerror = function() {
+                updateLoadEventCount(-1);
+                onFeatureTileError(url);
+            };
+            updateLoadEventCount(1);
+            xhr.send();
+        }
+    });
+    return src;
+}
+
+// a missing or bad feature tile -- we switch to the single feature file (which falls back to the geojson file)
+function onFeatureTileError(url) {
+    if ( featureTileErrorFlag ) {
+        return;
+    }
+    console.log('Could not load feature tile ' + url + ' -- using the single feature file instead');
+    featureTileErrorFlag = true;
+    setTimeout(useFeatureFile, 0);
+}
+
+// the source for the single feature file (all dimensions) -- we only load it once
+function getFeatureFileSource() {
+    if ( featureFileSource !== null ) {
+        return featureFileSource;
+    }
+    
+    var src;
+    if ( loadGeoJSONFlag && typeof fnGeoJSONBin !== 'undefined' && fnGeoJSONBin !== '' ) {
+        // we load the compact binary version of the features (much faster than parsing the geojson)
+        src = new ol.source.Vector();
+        updateLoadEventCount(1);
+        loadVectorsBinary(src);
+    }
+    else if ( loadGeoJSONFlag ) { 
+        src = new ol.source.Vector({
+            url: fnGeoJSON,
+            //crossOrigin: 'anonymous',
+            format: new ol.format.GeoJSON()
+        });
+        updateLoadEventCount(1);
+    } else {
+        // we are loading the geojson directly to work-around silly chrome (et al) CORS issue
+        // adapted from ol/featureloader.js
+        var format = new ol.format.GeoJSON();
+        var features = format.readFeatures(geojson, {featureProjection: projection});
+        src = new ol.source.Vector({
+            features: features
+        });
+    }
+    
+    // note: the feature tiles keep track of their own load events, this is the one for the file
+    var listenerKey = src.on('change', function(e) {
+        if (src.getState() == 'ready') {
+            updateLoadEventCount(-1);
+            ol.Observable.unByKey(listenerKey);
+        }
+        else if (src.getState() == 'error') {
+            updateLoadEventCount(-1);
+            ol.Observable.unByKey(listenerKey);
+            doModal('Image Load Error',
+                    'Could not load file: ' + src.url + '<br/>' +
+                    globalCORSWarning);
+        }
+    });
+    
+    featureFileSource = src;
+    return src;
+}
+
+// zoomed out too far for the feature tiles (see createFeatureTileSource) -- we show the single feature file instead
+function useFeatureFile() {
+    if ( vectorPoints === null || vectorPoints.getSource() === featureFileSource ) {
+        return;
+    }
+    vectorPoints.setSource(getFeatureFileSource());
+}
+
 function loadVectors() {
     if (vectorPoints !== null) {
         map.removeLayer(vectorPoints);
@@ -2451,37 +2720,12 @@ function loadVectors() {
 
     try {
         var src;
-        if ( loadGeoJSONFlag ) { 
-            src = new ol.source.Vector({
-                url: fnGeoJSON,
-                //crossOrigin: 'anonymous',
-                format: new ol.format.GeoJSON()
-            });
-            updateLoadEventCount(1);
+        if ( useFeatureTiles() ) {
+            src = createFeatureTileSource();
         } else {
-            // we are loading the geojson directly to work-around silly chrome (et al) CORS issue
-            // adapted from ol/featureloader.js
-            var format = new ol.format.GeoJSON();
-            var features = format.readFeatures(geojson, {featureProjection: projection});
-            src = new ol.source.Vector({
-                features: features
-            });
+            src = getFeatureFileSource();
         }
         
-        var listenerKey = src.on('change', function(e) {
-            if (src.getState() == 'ready') {
-                updateLoadEventCount(-1);
-                ol.Observable.unByKey(listenerKey);
-            }
-            else if (src.getState() == 'error') {
-                updateLoadEventCount(-1);
-                ol.Observable.unByKey(listenerKey);
-                doModal('Image Load Error',
-                        'Could not load file: ' + src.url + '<br/>' +
-                        globalCORSWarning);
-            }
-        });
-        
         vectorPoints = new ol.layer.Vector({
             myStackOrder: 300,
             source: src,
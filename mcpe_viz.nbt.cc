@@ -21,14 +21,7 @@
 
 namespace mcpe_viz {
 
-  std::string makeGeojsonHeader(double ix, double iy, bool adjustCoordFlag) {
-    char tmpstring[256];
-
-    std::string s =
-      "{"
-      "\"type\":\"Feature\","
-      "\"geometry\":{\"type\":\"Point\",\"coordinates\":["
-      ;
+  void appendGeojsonCoords(std::string& s, double ix, double iy, bool adjustCoordFlag) {
     if ( std::isnan(ix) || std::isnan(iy) ) {
       // we don't put out anything because "NaN" is not valid JSON
     } else {
@@ -38,19 +31,133 @@ namespace mcpe_viz {
         ix += 0.5; //todobig - plus or minus here? hmm
         iy += 0.5;
       }
-      sprintf(tmpstring,"%.1lf,%.1lf",ix,iy);
-      s += tmpstring;
+      appendFixed(s, ix, 1);
+      s += ',';
+      appendFixed(s, iy, 1);
     }
+  }
+  
+  std::string makeGeojsonHeader(double ix, double iy, bool adjustCoordFlag) {
+    std::string s =
+      "{"
+      "\"type\":\"Feature\","
+      "\"geometry\":{\"type\":\"Point\",\"coordinates\":["
+      ;
+    appendGeojsonCoords(s, ix, iy, adjustCoordFlag);
     s +=
       "]},"
       "\"properties\":{"
       ;
     return s;
   }
+
+  // marks the world coordinates put by makeGeojsonHeaderWorld when image coordinates are deferred
+  // note: the mark is only looked for right after the coordinates key (kGeojsonPointHeader), never in the properties,
+  //   because the properties can have player text (e.g. signs and names) in them
+  const char* kGeojsonDeferredMark = "@@";
+  const char* kGeojsonPointHeader = "{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\",\"coordinates\":[";
   
-  std::string makeGeojsonHeader_MultiPoint(int n, double *ix, double *iy) {
-    char tmpstring[256];
+  // the deferred world coordinates are the bits of the doubles in hex, so we get back exactly what we put
+  static void appendDeferredDouble(std::string& s, double v) {
+    uint64_t u;
+    memcpy(&u, &v, sizeof(u));
+    for (int32_t i=60; i >= 0; i -= 4) {
+      s += "0123456789abcdef"[(u >> i) & 0xf];
+    }
+  }
+
+  static bool parseDeferredDouble(const char*& p, double& v) {
+    uint64_t u = 0;
+    for (int32_t i=0; i < 16; i++, p++) {
+      int32_t d;
+      if ( *p >= '0' && *p <= '9' ) {
+        d = *p - '0';
+      } else if ( *p >= 'a' && *p <= 'f' ) {
+        d = *p - 'a' + 10;
+      } else {
+        return false;
+      }
+      u = (u << 4) | (uint64_t)d;
+    }
+    memcpy(&v, &u, sizeof(v));
+    return true;
+  }
+
+  static bool parseDeferredInt(const char*& p, int32_t& v) {
+    bool negFlag = ( *p == '-' );
+    if ( negFlag ) {
+      p++;
+    }
+    if ( *p < '0' || *p > '9' ) {
+      return false;
+    }
+    int64_t u = 0;
+    while ( *p >= '0' && *p <= '9' ) {
+      u = u * 10 + (*p++ - '0');
+      if ( u > 0x7fffffff ) {
+        return false;
+      }
+    }
+    v = (int32_t)( negFlag ? -u : u );
+    return true;
+  }
+  
+  std::string makeGeojsonHeaderWorld(int32_t dimId, double wx, double wz, bool adjustCoordFlag) {
+    if ( ! deferImageCoordsFlag ) {
+      double ix, iy;
+      worldPointToGeoJSONPoint(dimId, wx, wz, ix, iy);
+      return makeGeojsonHeader(ix, iy, adjustCoordFlag);
+    }
+
+    // we don't know the image bounds yet (single-pass mode), so we put the world coordinates -- see rebaseGeojsonCoords
+    // the format is: @@dimId,adjustCoordFlag,wx,wz@@
+    std::string s = kGeojsonPointHeader;
+    s += kGeojsonDeferredMark;
+    appendInt(s, dimId);
+    s += adjustCoordFlag ? ",1," : ",0,";
+    appendDeferredDouble(s, wx);
+    s += ',';
+    appendDeferredDouble(s, wz);
+    s += kGeojsonDeferredMark;
+    s +=
+      "]},"
+      "\"properties\":{"
+      ;
+    return s;
+  }
 
+  int32_t rebaseGeojsonCoords(std::string& s) {
+    const size_t headerLen = strlen(kGeojsonPointHeader);
+    const size_t markLen = strlen(kGeojsonDeferredMark);
+    if ( s.compare(0, headerLen, kGeojsonPointHeader) != 0 || s.compare(headerLen, markLen, kGeojsonDeferredMark) != 0 ) {
+      return 0;
+    }
+    size_t pstart = headerLen;
+    // note: the closing mark is followed by the end of the coordinates
+    size_t pend = s.find(kGeojsonDeferredMark, pstart + markLen);
+    if ( pend == std::string::npos || s.compare(pend + markLen, 1, "]") != 0 ) {
+      return -1;
+    }
+    
+    int32_t dimId, adjustCoordFlag;
+    double wx, wz;
+    const char* p = &s[pstart + markLen];
+    if ( ! parseDeferredInt(p, dimId) || *p++ != ',' ||
+         ! parseDeferredInt(p, adjustCoordFlag) || *p++ != ',' ||
+         ! parseDeferredDouble(p, wx) || *p++ != ',' ||
+         ! parseDeferredDouble(p, wz) || p != &s[pend] ) {
+      return -1;
+    }
+
+    double ix, iy;
+    worldPointToGeoJSONPoint(dimId, wx, wz, ix, iy);
+    std::string coords;
+    appendGeojsonCoords(coords, ix, iy, adjustCoordFlag != 0);
+    s.replace(pstart, (pend + markLen) - pstart, coords);
+    return 1;
+  }
+  
+  std::string makeGeojsonHeader_MultiPoint(int n, double *ix, double *iy) {
     std::string s =
       "{"
       "\"type\":\"Feature\","
@@ -66,8 +173,11 @@ namespace mcpe_viz {
         iy[i] += 0.5;
       }
       
-      sprintf(tmpstring,"[%.1lf,%.1lf]",ix[i],iy[i]);
-      s += tmpstring;
+      s += '[';
+      appendFixed(s, ix[i], 1);
+      s += ',';
+      appendFixed(s, iy[i], 1);
+      s += ']';
       if ( i < (n-1) ) {
         s += ",";
       }
@@ -196,99 +306,465 @@ namespace mcpe_viz {
   }
 
     
-  int32_t parseNbt( const char* hdr, const char* buf, int32_t bufLen, MyNbtTagList& tagList ) {
-    int32_t indent=0;
+  // low-level reads of little-endian nbt from a record buffer
+  class NbtBufferCursor {
+  protected:
+    const char* buf;
+    size_t bufLen;
+    size_t pos;
 
-    logger.msg(kLogInfo1,"%sNBT Decode Start\n",makeIndent(indent,hdr).c_str());
+    // note: libnbt++ does not limit this, but we do not want a bad record to blow the stack
+    static const int32_t kMaxDepth = 512;
 
-    // these help us look at dumped nbt data and match up LIST's and COMPOUND's
-    globalNbtListNumber=0;
-    globalNbtCompoundNumber=0;
-      
-    std::istringstream is(std::string(buf,bufLen));
-    nbt::io::stream_reader reader(is, endian::little);
+    NbtBufferCursor(const char* tbuf, size_t tbufLen) {
+      buf = tbuf;
+      bufLen = tbufLen;
+      pos = 0;
+    }
 
-    // remove all elements from taglist
-    tagList.clear();
+    void need(size_t n) {
+      if ( (bufLen - pos) < n ) {
+        // we ran out of data -- same as eof on the stream
+        pos = bufLen;
+        throw std::runtime_error("Unexpected end of data");
+      }
+    }
+
+    // note: same as myParseInt32 et al -- we assume a little-endian host
+    template <typename T>
+    T readNum() {
+      T v;
+      need(sizeof(T));
+      memcpy(&v, &buf[pos], sizeof(T));
+      pos += sizeof(T);
+      return v;
+    }
+
+    nbt::tag_type readType(bool allowEndFlag) {
+      int8_t t = readNum<int8_t>();
+      if ( t < (allowEndFlag ? 0 : 1) || t > (int8_t)nbt::tag_type::Int_Array ) {
+        char tmpstring[256];
+        sprintf(tmpstring, "Invalid tag type: %d", (int)t);
+        throw std::runtime_error(tmpstring);
+      }
+      return (nbt::tag_type)t;
+    }
+
+    std::string readString() {
+      uint16_t len = readNum<uint16_t>();
+      need(len);
+      std::string v(&buf[pos], len);
+      pos += len;
+      return v;
+    }
+
+    int32_t readLength() {
+      int32_t len = readNum<int32_t>();
+      if ( len < 0 ) {
+        throw std::runtime_error("Negative length");
+      }
+      return len;
+    }
+
+    // the string stays in the buffer
+    const char* readStringInPlace(int32_t& len) {
+      len = readNum<uint16_t>();
+      need(len);
+      const char* v = &buf[pos];
+      pos += len;
+      return v;
+    }
+
+    void skip(size_t n) {
+      need(n);
+      pos += n;
+    }
+
+    void checkDepth(int32_t depth) {
+      if ( depth > kMaxDepth ) {
+        throw std::runtime_error("Tags are nested too deeply");
+      }
+    }
+
+  public:
+    bool eof() const {
+      return pos >= bufLen;
+    }
+
+    size_t getPos() const {
+      return pos;
+    }
+  };
+
+
+  // reads nbt straight from a record buffer -- this makes the same tags as nbt::io::stream_reader,
+  // but without copying the buffer into a string stream and without iostream overhead
+  class NbtBufferReader : public NbtBufferCursor {
+  private:
+    template <typename T>
+    std::vector<T> readArray() {
+      int32_t len = readLength();
+      need((size_t)len * sizeof(T));
+      std::vector<T> v(len);
+      if ( len > 0 ) {
+        memcpy(&v[0], &buf[pos], (size_t)len * sizeof(T));
+      }
+      pos += (size_t)len * sizeof(T);
+      return v;
+    }
+
+    std::unique_ptr<nbt::tag> readPayload(nbt::tag_type type, int32_t depth) {
+      checkDepth(depth);
+      switch ( type ) {
+      case nbt::tag_type::Byte:
+        return std::unique_ptr<nbt::tag>(new nbt::tag_byte(readNum<int8_t>()));
+      case nbt::tag_type::Short:
+        return std::unique_ptr<nbt::tag>(new nbt::tag_short(readNum<int16_t>()));
+      case nbt::tag_type::Int:
+        return std::unique_ptr<nbt::tag>(new nbt::tag_int(readNum<int32_t>()));
+      case nbt::tag_type::Long:
+        return std::unique_ptr<nbt::tag>(new nbt::tag_long(readNum<int64_t>()));
+      case nbt::tag_type::Float:
+        return std::unique_ptr<nbt::tag>(new nbt::tag_float(readNum<float>()));
+      case nbt::tag_type::Double:
+        return std::unique_ptr<nbt::tag>(new nbt::tag_double(readNum<double>()));
+      case nbt::tag_type::Byte_Array:
+        return std::unique_ptr<nbt::tag>(new nbt::tag_byte_array(readArray<int8_t>()));
+      case nbt::tag_type::String:
+        return std::unique_ptr<nbt::tag>(new nbt::tag_string(readString()));
+      case nbt::tag_type::Int_Array:
+        return std::unique_ptr<nbt::tag>(new nbt::tag_int_array(readArray<int32_t>()));
+      case nbt::tag_type::List:
+        {
+          nbt::tag_type elType = readType(true);
+          int32_t len = readLength();
+          // note: like libnbt++, a list of TAG_End has no type (and we ignore the length)
+          if ( elType == nbt::tag_type::End ) {
+            return std::unique_ptr<nbt::tag>(new nbt::tag_list());
+          }
+          std::unique_ptr<nbt::tag_list> list(new nbt::tag_list(elType));
+          for (int32_t i=0; i < len; i++) {
+            list->push_back(readPayload(elType, depth + 1));
+          }
+          return std::unique_ptr<nbt::tag>(std::move(list));
+        }
+      case nbt::tag_type::Compound:
+        {
+          std::unique_ptr<nbt::tag_compound> compound(new nbt::tag_compound());
+          nbt::tag_type t;
+          while ( (t = readType(true)) != nbt::tag_type::End ) {
+            std::string key = readString();
+            compound->insert(key, readPayload(t, depth + 1));
+          }
+          return std::unique_ptr<nbt::tag>(std::move(compound));
+        }
+      default:
+        break;
+      }
+      throw std::runtime_error("Invalid tag type");
+    }
+
+  public:
+    NbtBufferReader(const char* tbuf, size_t tbufLen) : NbtBufferCursor(tbuf, tbufLen) {
+    }
+
+    MyNbtTag readTag() {
+      nbt::tag_type type = readType(false);
+      std::string key = readString();
+      return MyNbtTag(key, readPayload(type, 0));
+    }
+  };
+
+
+  // walks nbt in a record buffer and hands each tag to an NbtVisitor -- nothing is copied or allocated
+  // except the path, and the tags that the visitor skips are stepped over without being decoded
+  class NbtBufferWalker : public NbtBufferCursor {
+  private:
+    NbtVisitor& visitor;
+    NbtVisitor::Path path;
+
+    void skipPayload(nbt::tag_type type, int32_t depth) {
+      checkDepth(depth);
+      switch ( type ) {
+      case nbt::tag_type::Byte:
+        skip(1);
+        return;
+      case nbt::tag_type::Short:
+        skip(2);
+        return;
+      case nbt::tag_type::Int:
+      case nbt::tag_type::Float:
+        skip(4);
+        return;
+      case nbt::tag_type::Long:
+      case nbt::tag_type::Double:
+        skip(8);
+        return;
+      case nbt::tag_type::Byte_Array:
+        skip((size_t)readLength());
+        return;
+      case nbt::tag_type::Int_Array:
+        skip((size_t)readLength() * 4);
+        return;
+      case nbt::tag_type::String:
+        skip(readNum<uint16_t>());
+        return;
+      case nbt::tag_type::List:
+        {
+          nbt::tag_type elType = readType(true);
+          int32_t len = readLength();
+          if ( elType != nbt::tag_type::End ) {
+            for (int32_t i=0; i < len; i++) {
+              skipPayload(elType, depth + 1);
+            }
+          }
+          return;
+        }
+      case nbt::tag_type::Compound:
+        {
+          nbt::tag_type t;
+          while ( (t = readType(true)) != nbt::tag_type::End ) {
+            skip(readNum<uint16_t>());
+            skipPayload(t, depth + 1);
+          }
+          return;
+        }
+      default:
+        break;
+      }
+      throw std::runtime_error("Invalid tag type");
+    }
+
+    void visitPayload(nbt::tag_type type, const char* key, int32_t keyLen, int32_t index) {
+      NbtPathEntry e;
+      e.type = type;
+      e.key = key;
+      e.keyLen = keyLen;
+      e.index = index;
+      path.push_back(e);
+
+      int32_t depth = (int32_t)path.size() - 1;
+      checkDepth(depth);
+
+      if ( ! visitor.enterTag(path) ) {
+        skipPayload(type, depth);
+        path.pop_back();
+        return;
+      }
       
-    // read all tags
-    MyNbtTag t;
-    bool done = false;
-    std::istream& pis = reader.get_istr();
-    while ( !done && (pis) && (!pis.eof()) ) {
+      switch ( type ) {
+      case nbt::tag_type::Byte:
+        visitor.onInteger(path, readNum<int8_t>());
+        break;
+      case nbt::tag_type::Short:
+        visitor.onInteger(path, readNum<int16_t>());
+        break;
+      case nbt::tag_type::Int:
+        visitor.onInteger(path, readNum<int32_t>());
+        break;
+      case nbt::tag_type::Long:
+        visitor.onInteger(path, readNum<int64_t>());
+        break;
+      case nbt::tag_type::Float:
+        visitor.onDouble(path, readNum<float>());
+        break;
+      case nbt::tag_type::Double:
+        visitor.onDouble(path, readNum<double>());
+        break;
+      case nbt::tag_type::Byte_Array:
+      case nbt::tag_type::Int_Array:
+        {
+          int32_t len = readLength();
+          size_t elSize = (type == nbt::tag_type::Byte_Array) ? 1 : 4;
+          const char* data = &buf[pos];
+          skip((size_t)len * elSize);
+          visitor.onArray(path, data, len);
+        }
+        break;
+      case nbt::tag_type::String:
+        {
+          int32_t len;
+          const char* v = readStringInPlace(len);
+          visitor.onString(path, v, len);
+        }
+        break;
+      case nbt::tag_type::List:
+        {
+          nbt::tag_type elType = readType(true);
+          int32_t len = readLength();
+          if ( elType != nbt::tag_type::End ) {
+            for (int32_t i=0; i < len; i++) {
+              visitPayload(elType, "", 0, i);
+            }
+          }
+          visitor.leaveTag(path);
+        }
+        break;
+      case nbt::tag_type::Compound:
+        {
+          nbt::tag_type t;
+          int32_t i = 0;
+          while ( (t = readType(true)) != nbt::tag_type::End ) {
+            int32_t childKeyLen;
+            const char* childKey = readStringInPlace(childKeyLen);
+            visitPayload(t, childKey, childKeyLen, i++);
+          }
+          visitor.leaveTag(path);
+        }
+        break;
+      default:
+        throw std::runtime_error("Invalid tag type");
+      }
+
+      path.pop_back();
+    }
+
+  public:
+    NbtBufferWalker(const char* tbuf, size_t tbufLen, NbtVisitor& tvisitor)
+      : NbtBufferCursor(tbuf, tbufLen)
+      , visitor(tvisitor)
+    {
+      path.reserve(16);
+    }
+
+    void visitTag(int32_t index) {
+      path.clear();
+      nbt::tag_type type = readType(false);
+      int32_t keyLen;
+      const char* key = readStringInPlace(keyLen);
+      visitPayload(type, key, keyLen, index);
+    }
+
+    // step over a whole top-level tag without calling the visitor
+    void skipTag() {
+      nbt::tag_type type = readType(false);
+      skip(readNum<uint16_t>());
+      skipPayload(type, 0);
+    }
+  };
+
+
+  bool NbtVisitor::keyIs(const Path& path, const char* key) {
+    const NbtPathEntry& e = path.back();
+    return ( (size_t)e.keyLen == strlen(key) ) && ( memcmp(e.key, key, e.keyLen) == 0 );
+  }
+
+  
+  int32_t visitNbt( const char* buf, int32_t bufLen, int32_t numToRead, NbtVisitor& visitor ) {
+    NbtBufferWalker walker(buf, std::max(0, bufLen), visitor);
+
+    int32_t numRead = 0;
+    while ( ! walker.eof() ) {
       try {
-        // todo emplace_back?
-        tagList.push_back(reader.read_tag());
+        walker.visitTag(numRead);
       }
       catch (std::exception& e) {
         // check for eof which means all is well
-        if ( ! pis.eof() ) {
-          fprintf(stderr, "NBT exception: (%s) (eof=%s) (is=%s) (tc=%d) (pos=%d) (buflen=%d) (parseNbt)\n"
+        if ( ! walker.eof() ) {
+          fprintf(stderr, "NBT exception: (%s) (tc=%d) (pos=%d) (buflen=%d) (visitNbt)\n"
                   , e.what()
-                  , pis.eof() ? "true" : "false"
-                  , (pis) ? "true" : "false"
-                  , (int)tagList.size()
-                  , (int)pis.tellg()
+                  , numRead
+                  , (int)walker.getPos()
                   , bufLen
                   );
-          // todo - testing
-          //dumpBuffer("nbt-buffer", buf, bufLen);
+          return -1;
         }
-        done = true;
+        break;
+      }
+      if ( numToRead > 0 && ++numRead >= numToRead ) {
+        break;
       }
     }
-      
-    // iterate over the tags
-    for ( const auto& itt: tagList ) {
-      parseNbtTag( hdr, indent, itt );
-    }
-
-    logger.msg(kLogInfo1,"%sNBT Decode End (%d tags)\n",makeIndent(indent,hdr).c_str(), (int)tagList.size());
-
     return 0;
   }
 
+  
+  // the number of bytes used by the first numToRead tags in buf (or by all of them) -- the tags are skipped, not decoded
+  // note: if the data is bad or runs out we return bufLen so that callers that key on these bytes stay correct
+  int32_t measureNbt( const char* buf, int32_t bufLen, int32_t numToRead ) {
+    bufLen = std::max(0, bufLen);
+    NbtVisitor nullVisitor;
+    NbtBufferWalker walker(buf, bufLen, nullVisitor);
+
+    int32_t numRead = 0;
+    while ( ! walker.eof() ) {
+      try {
+        walker.skipTag();
+      }
+      catch (std::exception&) {
+        return bufLen;
+      }
+      if ( numToRead > 0 && ++numRead >= numToRead ) {
+        break;
+      }
+    }
+    return (int32_t)walker.getPos();
+  }
 
-  int32_t parseNbtQuiet( const char* buf, int32_t bufLen, int32_t numToRead, MyNbtTagList& tagList ) {
-    std::istringstream is(std::string(buf,bufLen));
-    nbt::io::stream_reader reader(is, endian::little);
+  
+  // read all of the tags in buf (or the first numToRead tags)
+  // note: we only complain about bad data, running out of data is the normal way to stop
+  int32_t readNbtTags( const char* buf, int32_t bufLen, int32_t numToRead, MyNbtTagList& tagList, const char* caller ) {
+    NbtBufferReader reader(buf, std::max(0, bufLen));
 
     // remove all elements from taglist
     tagList.clear();
       
     // read all tags
-    MyNbtTag t;
-    bool done = false;
     int32_t numRead = 0;
-    std::istream& pis = reader.get_istr();
-    while ( !done && (pis) && (!pis.eof()) ) {
-      if ( numToRead > 0 && ++numRead >= numToRead ) {
-        done = true;
-      }
+    while ( ! reader.eof() ) {
       try {
-        // todo emplace_back?
-        tagList.push_back(reader.read_tag());
+        tagList.push_back(reader.readTag());
       }
       catch (std::exception& e) {
         // check for eof which means all is well
-        if ( ! pis.eof() ) {
-          fprintf(stderr, "NBT exception: (%s) (eof=%s) (is=%s) (tc=%d) (pos=%d) (buflen=%d) (parseNbtQuiet)\n"
+        if ( ! reader.eof() ) {
+          fprintf(stderr, "NBT exception: (%s) (tc=%d) (pos=%d) (buflen=%d) (%s)\n"
                   , e.what()
-                  , pis.eof() ? "true" : "false"
-                  , (pis) ? "true" : "false"
                   , (int)tagList.size()
-                  , (int)pis.tellg()
+                  , (int)reader.getPos()
                   , bufLen
+                  , caller
                   );
           // todo - testing
           //dumpBuffer("nbt-buffer", buf, bufLen);
         }
-        done = true;
+        break;
+      }
+      if ( numToRead > 0 && ++numRead >= numToRead ) {
+        break;
       }
     }
+    return 0;
+  }
+
+  
+  int32_t parseNbt( const char* hdr, const char* buf, int32_t bufLen, MyNbtTagList& tagList ) {
+    int32_t indent=0;
+
+    logger.msg(kLogInfo1,"%sNBT Decode Start\n",makeIndent(indent,hdr).c_str());
+
+    // these help us look at dumped nbt data and match up LIST's and COMPOUND's
+    globalNbtListNumber=0;
+    globalNbtCompoundNumber=0;
+
+    readNbtTags(buf, bufLen, 0, tagList, "parseNbt");
+      
+    // iterate over the tags
+    for ( const auto& itt: tagList ) {
+      parseNbtTag( hdr, indent, itt );
+    }
+
+    logger.msg(kLogInfo1,"%sNBT Decode End (%d tags)\n",makeIndent(indent,hdr).c_str(), (int)tagList.size());
 
     return 0;
   }
+
+
+  int32_t parseNbtQuiet( const char* buf, int32_t bufLen, int32_t numToRead, MyNbtTagList& tagList ) {
+    readNbtTags(buf, bufLen, numToRead, tagList, "parseNbtQuiet");
+    return 0;
+  }
   
   
   // todo - use this throughout parsing or is it madness? :)
@@ -340,17 +816,21 @@ namespace mcpe_viz {
     bool isValid() {
       return ! ( std::isnan(x) || std::isnan(y) );
     }
-    std::string toGeoJSON() {
+    void appendGeoJSON(std::string& s) {
       // todo - how to report invalid in geojson?
       // if ( valid ) {
-      std::ostringstream str;
       if ( std::isnan(x) || std::isnan(y) ) {
         // we don't put out anything because "NaN" is not valid JSON
-        str << "";
       } else {
-        str << x << "," << y;
+        appendNumber(s, x);
+        s += ',';
+        appendNumber(s, y);
       }
-      return str.str();
+    }
+    std::string toGeoJSON() {
+      std::string s;
+      appendGeoJSON(s);
+      return s;
     }
     std::string toString() {
       if ( valid ) {
@@ -388,17 +868,23 @@ namespace mcpe_viz {
     bool isValid() {
       return ! ( std::isnan(x) || std::isnan(y) || std::isnan(z) );
     }
-    std::string toGeoJSON() {
+    void appendGeoJSON(std::string& s) {
       // todo - how to report invalid in geojson?
       // if ( valid ) {
-      std::ostringstream str;
       if ( std::isnan(x) || std::isnan(y) || std::isnan(z) ) {
         // we don't put out anything because "NaN" is not valid JSON
-        str << "";
       } else {
-        str << x << "," << y << "," << z;
+        appendNumber(s, x);
+        s += ',';
+        appendNumber(s, y);
+        s += ',';
+        appendNumber(s, z);
       }
-      return str.str();
+    }
+    std::string toGeoJSON() {
+      std::string s;
+      appendGeoJSON(s);
+      return s;
     }
     std::string toString() {
       if ( valid ) {
@@ -423,6 +909,10 @@ namespace mcpe_viz {
       }
     }
     std::string toStringWithImageCoords(int32_t dimId) {
+      if ( deferImageCoordsFlag ) {
+        // image coordinates are not known yet
+        return std::string("(" + toString() + ")");
+      }
       return std::string("(" + toString() + " @ image " + toStringImageCoords(dimId) + ")");
     }
   };
@@ -430,7 +920,7 @@ namespace mcpe_viz {
 
 
   // todo - each value in these structs should be an object that does "valid" checking
-  class ParsedEnchantment {
+  class ParsedEnchantment : public ArenaAllocated {
   public:
     MyValue<int32_t> id;
     MyValue<int32_t> level;
@@ -490,7 +980,7 @@ namespace mcpe_viz {
     
 
 
-  class ParsedItem {
+  class ParsedItem : public ArenaAllocated {
   public:
     bool valid;
     bool armorFlag;
@@ -648,8 +1138,10 @@ namespace mcpe_viz {
       }
 
       if ( showCountFlag && count >= 0 ) {
-        sprintf(tmpstring,"\"Count\":\"%d\"", count);
-        list.push_back(std::string(tmpstring));
+        s = "\"Count\":\"";
+        appendInt(s, count);
+        s += "\"";
+        list.push_back(s);
       }
         
       if ( enchantmentList.size() > 0 ) {
@@ -700,8 +1192,9 @@ namespace mcpe_viz {
           imgId = globalIconImageId++;
           imageFileMap.insert( std::make_pair(fImage,imgId) );
         }
-        sprintf(tmpstring,"\"imgid\":%d",imgId);
-        list.push_back(tmpstring);
+        s = "\"imgid\":";
+        appendInt(s, imgId);
+        list.push_back(s);
       }
       
 
@@ -777,7 +1270,7 @@ namespace mcpe_viz {
       
 
 
-  class ParsedEntity {
+  class ParsedEntity : public ArenaAllocated {
   public:
     Point3d<int> bedPosition;
     Point3d<int> spawn;
@@ -931,7 +1424,6 @@ namespace mcpe_viz {
     std::string toGeoJSON(int32_t forceDimensionId) {
       std::vector<std::string> list;
       std::string s = "";
-      char tmpstring[1025];
 
       // we make sure that the entity is valid -- have seen rare occurances of mobs with "nan" in pos et al
       if ( ! pos.isValid() || ! rotation.isValid() ) {
@@ -939,42 +1431,42 @@ namespace mcpe_viz {
         return "";
       }
       
-      double ix, iy;
-      worldPointToGeoJSONPoint(forceDimensionId, pos.x,pos.z, ix,iy);
-      s += makeGeojsonHeader(ix,iy);
+      s += makeGeojsonHeaderWorld(forceDimensionId, pos.x,pos.z);
 
       if ( has_key(entityInfoList, idShort) ) {
-        sprintf(tmpstring,"\"Name\":\"%s\"", entityInfoList[idShort]->name.c_str());
-        list.push_back(std::string(tmpstring));
-        sprintf(tmpstring,"\"etype\":\"%s\"", entityInfoList[idShort]->etype.c_str());
-        list.push_back(std::string(tmpstring));
+        list.push_back("\"Name\":\"" + entityInfoList[idShort]->name + "\"");
+        list.push_back("\"etype\":\"" + entityInfoList[idShort]->etype + "\"");
       } else {
-        sprintf(tmpstring,"\"Name\":\"*UNKNOWN: id=%d 0x%x\"", idShort,idShort);
-        list.push_back(std::string(tmpstring));
+        std::string sname = "\"Name\":\"*UNKNOWN: id=";
+        appendInt(sname, idShort);
+        sname += " 0x";
+        appendHex(sname, (uint32_t)idShort);
+        sname += "\"";
+        list.push_back(sname);
       }
 
-      sprintf(tmpstring,"\"id\":\"%d\"", idShort);
-      list.push_back(std::string(tmpstring));
+      std::string sprop = "\"id\":\"";
+      appendInt(sprop, idShort);
+      sprop += "\"";
+      list.push_back(sprop);
 
-      sprintf(tmpstring,"\"idFull\":\"%d\"", idFull);
-      list.push_back(std::string(tmpstring));
+      sprop = "\"idFull\":\"";
+      appendInt(sprop, idFull);
+      sprop += "\"";
+      list.push_back(sprop);
 
       // todo - needed?
       if ( playerLocalFlag || playerRemoteFlag ) {
         list.push_back(std::string("\"player\":\"true\""));
 
-        sprintf(tmpstring,"\"playerType\":\"%s\"", playerType.c_str());
-        list.push_back(std::string(tmpstring));
+        list.push_back("\"playerType\":\"" + playerType + "\"");
 
-        sprintf(tmpstring,"\"playerId\":\"%s\"", playerId.c_str());
-        list.push_back(std::string(tmpstring));
+        list.push_back("\"playerId\":\"" + playerId + "\"");
 
         if ( has_key(playerIdToName, playerId) ) {
-          sprintf(tmpstring,"\"playerName\":\"%s\"", playerIdToName[playerId].c_str());
-          list.push_back(std::string(tmpstring));
+          list.push_back("\"playerName\":\"" + playerIdToName[playerId] + "\"");
         } else {
-          sprintf(tmpstring,"\"playerName\":\"*UNKNOWN*\"");
-          list.push_back(std::string(tmpstring));
+          list.push_back(std::string("\"playerName\":\"*UNKNOWN*\""));
           // we log it to screen so that people have an easier time adding new player name mappings
           if ( playerId.length() > 0 ) {
             slogger.msg(kLogInfo1,"INFO: Unmapped remote player: %s\n", playerId.c_str());
@@ -986,21 +1478,31 @@ namespace mcpe_viz {
 
       if ( forceDimensionId >= 0 ) {
         // getting dimension name from myWorld is more trouble than it's worth here :)
-        sprintf(tmpstring,"\"Dimension\":\"%d\"", forceDimensionId);
-        list.push_back(std::string(tmpstring));
+        sprop = "\"Dimension\":\"";
+        appendInt(sprop, forceDimensionId);
+        sprop += "\"";
+        list.push_back(sprop);
       }
 
-      sprintf(tmpstring, "\"Pos\":[%s]", pos.toGeoJSON().c_str());
-      list.push_back(std::string(tmpstring));
+      sprop = "\"Pos\":[";
+      pos.appendGeoJSON(sprop);
+      sprop += "]";
+      list.push_back(sprop);
 
-      sprintf(tmpstring, "\"Rotation\":[%s]", rotation.toGeoJSON().c_str());
-      list.push_back(std::string(tmpstring));
+      sprop = "\"Rotation\":[";
+      rotation.appendGeoJSON(sprop);
+      sprop += "]";
+      list.push_back(sprop);
         
       if ( playerLocalFlag || playerRemoteFlag ) {
-        sprintf(tmpstring,"\"BedPos\":[%s]", bedPosition.toGeoJSON().c_str());
-        list.push_back(std::string(tmpstring));
-        sprintf(tmpstring,"\"Spawn\":[%s]", spawn.toGeoJSON().c_str());
-        list.push_back(std::string(tmpstring));
+        sprop = "\"BedPos\":[";
+        bedPosition.appendGeoJSON(sprop);
+        sprop += "]";
+        list.push_back(sprop);
+        sprop = "\"Spawn\":[";
+        spawn.appendGeoJSON(sprop);
+        sprop += "]";
+        list.push_back(sprop);
       }
 
       if ( armorList.size() > 0 ) {
@@ -1149,6 +1651,8 @@ namespace mcpe_viz {
 
         worldPointToGeoJSONPoint(actualDimensionId, pos.x,pos.z, playerPositionImageX, playerPositionImageY);
         playerPositionDimensionId = actualDimensionId;
+        playerPositionWorldX = pos.x;
+        playerPositionWorldZ = pos.z;
         
         fprintf(stderr,"Player Position: Dimension=%d Pos=%s Rotation=(%lf, %lf)\n", actualDimensionId, pos.toStringWithImageCoords(actualDimensionId).c_str(), rotation.x,rotation.y);
       }
@@ -1225,7 +1729,7 @@ namespace mcpe_viz {
 
 
 
-  class ParsedTileEntity {
+  class ParsedTileEntity : public ArenaAllocated {
   public:
     Point3d<double> pos;
     Point2d<int32_t> pairChest;
@@ -1403,16 +1907,22 @@ namespace mcpe_viz {
       if ( entityId > 0 ) {
         list.push_back("\"Name\":\"MobSpawner\"");
         std::string ts = "\"MobSpawner\":{";
-        sprintf(tmpstring, "\"entityId\":\"%d (0x%x)\",", entityId, entityId);
-        ts += tmpstring;
+        ts += "\"entityId\":\"";
+        appendInt(ts, entityId);
+        ts += " (0x";
+        appendHex(ts, (uint32_t)entityId);
+        ts += ")\",";
           
         // todo - the entityid is weird.  lsb appears to be entity type; high bytes are ??
         int32_t eid = entityId & 0xff;
         if ( has_key(entityInfoList, eid) ) {
           ts += "\"Name\":\"" + entityInfoList[eid]->name + "\"";
         } else {
-          sprintf(tmpstring,"\"Name\":\"(UNKNOWN: id=%d 0x%x)\"",eid,eid);
-          ts += tmpstring;
+          ts += "\"Name\":\"(UNKNOWN: id=";
+          appendInt(ts, eid);
+          ts += " 0x";
+          appendHex(ts, (uint32_t)eid);
+          ts += ")\"";
         }
         ts += "}";
         list.push_back(ts);
@@ -1422,15 +1932,17 @@ namespace mcpe_viz {
         std::string s="";
 
         list.push_back(std::string("\"TileEntity\":\"true\""));
-        sprintf(tmpstring,"\"Dimension\":\"%d\"", forceDimensionId);
-        list.push_back(std::string(tmpstring));
+        std::string ts = "\"Dimension\":\"";
+        appendInt(ts, forceDimensionId);
+        ts += "\"";
+        list.push_back(ts);
 
-        sprintf(tmpstring, "\"Pos\":[%s]", pos.toGeoJSON().c_str());
-        list.push_back(std::string(tmpstring));
+        ts = "\"Pos\":[";
+        pos.appendGeoJSON(ts);
+        ts += "]";
+        list.push_back(ts);
           
-        double ix, iy;
-        worldPointToGeoJSONPoint(forceDimensionId, pos.x,pos.z, ix,iy);
-        s += makeGeojsonHeader(ix,iy);
+        s += makeGeojsonHeaderWorld(forceDimensionId, pos.x,pos.z);
           
         int32_t i = list.size();
         for (const auto& iter : list ) {
@@ -1882,7 +2394,7 @@ namespace mcpe_viz {
 
       std::string geojson = entity->toGeoJSON(actualDimensionId);
       if ( geojson.length() > 0 ) {
-        listGeoJSON.push_back( geojson );
+        geojsonSink.add( geojson );
       }
 
       entityList.push_back( std::move(entity) );
@@ -2112,7 +2624,7 @@ namespace mcpe_viz {
 
         std::string json = tileEntity->toGeoJSON(dimensionId);
         if ( json.size() > 0 ) {
-          listGeoJSON.push_back( json );
+          geojsonSink.add( json );
         }
           
         tileEntityList.push_back( std::move(tileEntity) );
@@ -2152,37 +2664,46 @@ namespace mcpe_viz {
     }
     std::string toGeoJSON() {
       std::vector<std::string> list;
-      char tmpstring[1025];
 
       // note: we fake this as a tile entity so that it is easy to deal with in js
       list.push_back(std::string("\"TileEntity\":\"true\""));
 
       list.push_back("\"Name\":\"NetherPortal\"");
 
-      sprintf(tmpstring,"\"DimId\":\"%d\"", dimId);
-      list.push_back(tmpstring);
-
-      sprintf(tmpstring,"\"Span\":\"%d\"", span);
-      list.push_back(tmpstring);
-
-      sprintf(tmpstring,"\"Xa\":\"%d\"", xa);
-      list.push_back(tmpstring);
-
-      sprintf(tmpstring,"\"Za\":\"%d\"", za);
-      list.push_back(tmpstring);
+      std::string sprop = "\"DimId\":\"";
+      appendInt(sprop, dimId);
+      sprop += "\"";
+      list.push_back(sprop);
+
+      sprop = "\"Span\":\"";
+      appendInt(sprop, span);
+      sprop += "\"";
+      list.push_back(sprop);
+
+      sprop = "\"Xa\":\"";
+      appendInt(sprop, xa);
+      sprop += "\"";
+      list.push_back(sprop);
+
+      sprop = "\"Za\":\"";
+      appendInt(sprop, za);
+      sprop += "\"";
+      list.push_back(sprop);
         
       if ( list.size() > 0 ) {
         std::string s="";
 
-        sprintf(tmpstring,"\"Dimension\":\"%d\"", dimId);
-        list.push_back(std::string(tmpstring));
+        sprop = "\"Dimension\":\"";
+        appendInt(sprop, dimId);
+        sprop += "\"";
+        list.push_back(sprop);
 
-        sprintf(tmpstring, "\"Pos\":[%s]", pos.toGeoJSON().c_str());
-        list.push_back(std::string(tmpstring));
+        sprop = "\"Pos\":[";
+        pos.appendGeoJSON(sprop);
+        sprop += "]";
+        list.push_back(sprop);
           
-        double ix, iy;
-        worldPointToGeoJSONPoint(dimId, pos.x,pos.z, ix,iy);
-        s += makeGeojsonHeader(ix,iy);
+        s += makeGeojsonHeaderWorld(dimId, pos.x,pos.z);
           
         int32_t i = list.size();
         for (const auto& iter : list ) {
@@ -2254,7 +2775,7 @@ namespace mcpe_viz {
                 
               std::string json = portal->toGeoJSON();
               if ( json.size() > 0 ) {
-                listGeoJSON.push_back( json );
+                geojsonSink.add( json );
               }
                 
               portalList.push_back( std::move(portal) );
@@ -2579,9 +3100,7 @@ namespace mcpe_viz {
         // todobig - just a test
 #if 1
         // point style
-        double ix, iy;
-        worldPointToGeoJSONPoint(0, fpos.x,fpos.z, ix,iy);
-        s += makeGeojsonHeader(ix,iy,false);
+        s += makeGeojsonHeaderWorld(0, fpos.x,fpos.z, false);
 #else
         // multi-point style
         int npoints = doorList.size() + 1;
@@ -2659,7 +3178,7 @@ namespace mcpe_viz {
               
               std::string json = village->toGeoJSON();
               if ( json.size() > 0 ) {
-                listGeoJSON.push_back( json );
+                geojsonSink.add( json );
               }
               
               villageList.push_back( std::move(village) );
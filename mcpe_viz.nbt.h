@@ -22,11 +22,52 @@ namespace mcpe_viz {
   typedef std::vector< MyNbtTag > MyNbtTagList;
 
 
+  // one step of the path to a tag that is being visited
+  struct NbtPathEntry {
+    nbt::tag_type type;
+    // note: not null terminated, and empty for list elements
+    const char* key;
+    int32_t keyLen;
+    // index in the parent list or compound (or of the top-level tag)
+    int32_t index;
+  };
+
+  // callbacks for visitNbt() -- override the ones you want
+  // note: path.back() is the tag itself; strings, keys and arrays point into the record buffer
+  class NbtVisitor {
+  public:
+    typedef std::vector<NbtPathEntry> Path;
+    
+    virtual ~NbtVisitor() {}
+
+    // return false to skip this tag (for a list or compound this skips the whole subtree)
+    virtual bool enterTag(const Path& /*path*/) { return true; }
+    // called after the children of a list or compound
+    virtual void leaveTag(const Path& /*path*/) {}
+    // byte, short, int and long
+    virtual void onInteger(const Path& /*path*/, int64_t /*v*/) {}
+    // float and double
+    virtual void onDouble(const Path& /*path*/, double /*v*/) {}
+    virtual void onString(const Path& /*path*/, const char* /*s*/, int32_t /*len*/) {}
+    // byte and int arrays -- count elements of raw little-endian data
+    virtual void onArray(const Path& /*path*/, const char* /*data*/, int32_t /*count*/) {}
+
+    static bool keyIs(const Path& path, const char* key);
+  };
+
+  
+  void appendGeojsonCoords(std::string& s, double ix, double iy, bool adjustCoordFlag);
   std::string makeGeojsonHeader(double ix, double iy, bool adjustCoordFlag = true);
+  std::string makeGeojsonHeaderWorld(int32_t dimId, double wx, double wz, bool adjustCoordFlag = true);
+  int32_t rebaseGeojsonCoords(std::string& s);
   
   int32_t parseNbt( const char* hdr, const char* buf, int32_t bufLen, MyNbtTagList& tagList );
 
   int32_t parseNbtQuiet( const char* buf, int32_t bufLen, int32_t numToRead, MyNbtTagList& tagList );
+
+  int32_t visitNbt( const char* buf, int32_t bufLen, int32_t numToRead, NbtVisitor& visitor );
+
+  int32_t measureNbt( const char* buf, int32_t bufLen, int32_t numToRead );
     
   int32_t parseNbt_entity(int32_t dimensionId, const std::string& dimName, MyNbtTagList &tagList,
                       bool playerLocalFlag, bool playerRemoteFlag, const std::string& playerType, const std::string& playerId);
@@ -111,6 +111,64 @@ namespace mcpe_viz {
     return ret;
   }
 
+  // remove whitespace (outside of strings) and trailing zeros from decimal numbers (e.g. "1.50" -> "1.5"; "12.0" -> "12")
+  // note: numbers with an exponent are left alone
+  void compactJson(const std::string& in, std::string& out) {
+    out.clear();
+    out.reserve(in.size());
+    const char* p = in.data();
+    const char* pend = p + in.size();
+    while ( p < pend ) {
+      const char c = *p;
+      if ( c == '"' ) {
+        // strings are copied as-is
+        const char* q = p + 1;
+        while ( q < pend && *q != '"' ) {
+          if ( *q == '\\' && (q + 1) < pend ) {
+            q++;
+          }
+          q++;
+        }
+        if ( q < pend ) {
+          q++;
+        }
+        out.append(p, q - p);
+        p = q;
+      }
+      else if ( c == ' ' || c == '\n' || c == '\r' || c == '\t' ) {
+        p++;
+      }
+      else if ( c == '-' || ( c >= '0' && c <= '9' ) ) {
+        const char* q = p + 1;
+        bool dotFlag = false, expFlag = false;
+        while ( q < pend && ( ( *q >= '0' && *q <= '9' ) || *q == '.' || *q == 'e' || *q == 'E' || *q == '+' || *q == '-' ) ) {
+          if ( *q == '.' ) {
+            dotFlag = true;
+          }
+          else if ( *q == 'e' || *q == 'E' ) {
+            expFlag = true;
+          }
+          q++;
+        }
+        const char* qend = q;
+        if ( dotFlag && ! expFlag ) {
+          while ( qend[-1] == '0' ) {
+            qend--;
+          }
+          if ( qend[-1] == '.' ) {
+            qend--;
+          }
+        }
+        out.append(p, qend - p);
+        p = q;
+      }
+      else {
+        out += c;
+        p++;
+      }
+    }
+  }
+
  
   // hacky file copying funcs
   typedef std::vector< std::pair<std::string, std::string> > StringReplacementList;
@@ -303,6 +361,29 @@ namespace mcpe_viz {
     return unlink(fn.c_str());
   }
 
+  // move fnSrc to fnDest, replacing fnDest if it exists
+  // note: on windows rename() fails when fnDest exists, so we use MoveFileEx there
+  int32_t replaceFile ( const std::string& fnSrc, const std::string& fnDest ) {
+#if defined(WIN32)
+    if ( MoveFileEx(fnSrc.c_str(), fnDest.c_str(), MOVEFILE_REPLACE_EXISTING) != 0 ) {
+      return 0;
+    }
+    int32_t err = GetLastError();
+    slogger.msg(kLogInfo1,"ERROR: replaceFile failed for src (%s) to dest (%s) error-code (%d)\n", fnSrc.c_str(), fnDest.c_str(), err);
+    return -1;
+#else
+    return rename(fnSrc.c_str(), fnDest.c_str());
+#endif
+  }
+
+  int32_t seekFile ( FILE* fp, int64_t offset ) {
+#if defined(WIN32)
+    return _fseeki64(fp, offset, SEEK_SET);
+#else
+    return fseeko(fp, (off_t)offset, SEEK_SET);
+#endif
+  }
+
   // from: http://kickjava.com/src/org/eclipse/swt/graphics/RGB.java.htm
   int32_t rgb2hsb(int32_t red, int32_t green, int32_t blue, double& hue, double& saturation, double &brightness) {
     double r = (double)red / 255.0;
@@ -635,6 +716,14 @@ namespace mcpe_viz {
     }
     fprintf(stderr,"\n");
   }
+
+  uint64_t hashBytes( uint64_t h, const char* buf, size_t bufLen) {
+    for (size_t i=0; i<bufLen; i++) {
+      h ^= (uint8_t)buf[i];
+      h *= 0x100000001b3ULL;
+    }
+    return h;
+  }
   
 } // namespace mcpe_viz
 
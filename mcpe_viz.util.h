@@ -15,13 +15,19 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <set>
 #include <algorithm>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
 #include <string.h>
 #include <png.h>
 #include <sys/stat.h>
 #include <libgen.h>
 #include <math.h>
+#include <cmath>
 #include <cerrno>
 #include "mcpe_viz.version.h"
 
@@ -47,6 +53,8 @@ namespace mcpe_viz {
   
   std::string escapeString(const std::string& s, const std::string& escapeChars);
 
+  void compactJson(const std::string& in, std::string& out);
+
   std::string makeIndent(int32_t indent, const char* hdr);
   
   typedef std::vector< std::pair<std::string, std::string> > StringReplacementList;
@@ -58,11 +66,299 @@ namespace mcpe_viz {
   int32_t copyDirToDir ( const std::string& dirSrc, const std::string& dirDest, bool checkExistingFlag );
 
   int32_t deleteFile ( const std::string& fn );
+
+  int32_t replaceFile ( const std::string& fnSrc, const std::string& fnDest );
+
+  // seek to an absolute offset (works past 2GB)
+  int32_t seekFile ( FILE* fp, int64_t offset );
   
   bool vectorContains( const std::vector<int> &v, int32_t i );
 
   void dumpBuffer( const char* header, const char* buf, size_t bufLen);
 
+  // 64-bit FNV-1a -- start with kHashBytesInit, feed the result back in to hash more data
+  const uint64_t kHashBytesInit = 0xcbf29ce484222325ULL;
+  uint64_t hashBytes( uint64_t h, const char* buf, size_t bufLen);
+
+  // fast number formatting for the json/geojson output -- these append to s (no temp strings, no sprintf)
+  // note: the output is the same as sprintf: appendInt is "%d", appendHex is "%x", appendFixed is "%.Nf", appendGeneral is "%g"
+  inline void appendInt(std::string& s, int64_t v) {
+    char buf[24];
+    char* p = buf + sizeof(buf);
+    uint64_t u = ( v < 0 ) ? ( 0 - (uint64_t)v ) : (uint64_t)v;
+    do {
+      *--p = (char)('0' + (u % 10));
+      u /= 10;
+    } while ( u );
+    if ( v < 0 ) {
+      *--p = '-';
+    }
+    s.append(p, (buf + sizeof(buf)) - p);
+  }
+
+  // "%x"
+  inline void appendHex(std::string& s, uint32_t v) {
+    char buf[8];
+    char* p = buf + sizeof(buf);
+    do {
+      *--p = "0123456789abcdef"[v & 0xf];
+      v >>= 4;
+    } while ( v );
+    s.append(p, (buf + sizeof(buf)) - p);
+  }
+
+  // helper for appendFixed and appendGeneral -- returns false when the caller needs to use sprintf
+  // note: we give up on big values and on values that are too close to a rounding tie to be sure
+  inline bool appendFixed_fast(std::string& s, double v, int32_t decimals, bool trimFlag, double limit) {
+    static const double kScale[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+    if ( decimals < 0 || decimals > 9 || ! std::isfinite(v) ) {
+      return false;
+    }
+    const double t = fabs(v) * kScale[decimals];
+    if ( ! ( t < limit ) ) {
+      return false;
+    }
+    const double ft = floor(t);
+    const double frac = t - ft;
+    if ( fabs(frac - 0.5) <= 1e-6 ) {
+      return false;
+    }
+    uint64_t u = (uint64_t)ft + ( ( frac > 0.5 ) ? 1 : 0 );
+    if ( (double)u >= limit ) {
+      // we rounded up to the next power of ten
+      return false;
+    }
+    if ( trimFlag ) {
+      while ( decimals > 0 && ( u % 10 ) == 0 ) {
+        u /= 10;
+        decimals--;
+      }
+    }
+    char buf[32];
+    char* p = buf + sizeof(buf);
+    for (int32_t i=0; i < decimals; i++) {
+      *--p = (char)('0' + (u % 10));
+      u /= 10;
+    }
+    if ( decimals > 0 ) {
+      *--p = '.';
+    }
+    do {
+      *--p = (char)('0' + (u % 10));
+      u /= 10;
+    } while ( u );
+    if ( std::signbit(v) ) {
+      *--p = '-';
+    }
+    s.append(p, (buf + sizeof(buf)) - p);
+    return true;
+  }
+
+  inline void appendFixed(std::string& s, double v, int32_t decimals) {
+    if ( appendFixed_fast(s, v, decimals, false, 1e9) ) {
+      return;
+    }
+    char buf[512];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    s += buf;
+  }
+
+  inline void appendGeneral(std::string& s, double v) {
+    // %g puts 6 significant digits (without trailing zeros) and no exponent for 1e-4 <= |v| < 1e6
+    static const double kPow10[] = { 1e-4, 1e-3, 1e-2, 1e-1, 1e0, 1e1, 1e2, 1e3, 1e4, 1e5 };
+    const double a = fabs(v);
+    if ( a == 0.0 ) {
+      s += std::signbit(v) ? "-0" : "0";
+      return;
+    }
+    if ( a >= 1e-4 && a < 1e6 ) {
+      int32_t e = 5;
+      while ( e > -4 && a < kPow10[e + 4] ) {
+        e--;
+      }
+      if ( appendFixed_fast(s, v, 5 - e, true, 1e6) ) {
+        return;
+      }
+    }
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%g", v);
+    s += buf;
+  }
+
+  // for templates (e.g. Point3d<T>) -- same output as std::ostream
+  inline void appendNumber(std::string& s, int32_t v) { appendInt(s, v); }
+  inline void appendNumber(std::string& s, int64_t v) { appendInt(s, v); }
+  inline void appendNumber(std::string& s, float v) { appendGeneral(s, v); }
+  inline void appendNumber(std::string& s, double v) { appendGeneral(s, v); }
+
+  // hands out fixed-size blocks from large slabs -- for the many small objects that we keep for a whole run
+  // note: this is thread-safe; freed blocks are reused but slabs are never returned
+  class SlabPool {
+  private:
+    size_t blockSize;
+    size_t blocksPerSlab;
+    std::vector< std::unique_ptr<char[]> > slabs;
+    size_t slabUsedCt;
+    std::vector<void*> freeList;
+    size_t liveCt;
+    size_t peakLiveCt;
+    int64_t allocCt;
+    std::mutex mtx;
+
+  public:
+    SlabPool(size_t tblockSize, size_t tblocksPerSlab) {
+      // keep the blocks aligned
+      const size_t align = alignof(std::max_align_t);
+      blockSize = (tblockSize + align - 1) & ~(align - 1);
+      blocksPerSlab = std::max((size_t)1, tblocksPerSlab);
+      slabUsedCt = blocksPerSlab;
+      liveCt = 0;
+      peakLiveCt = 0;
+      allocCt = 0;
+    }
+
+    size_t getBlockSize() const { return blockSize; }
+    
+    void* alloc() {
+      std::lock_guard<std::mutex> lock(mtx);
+      liveCt++;
+      allocCt++;
+      peakLiveCt = std::max(peakLiveCt, liveCt);
+      if ( freeList.size() > 0 ) {
+        void* p = freeList.back();
+        freeList.pop_back();
+        return p;
+      }
+      if ( slabUsedCt >= blocksPerSlab ) {
+        slabs.push_back( std::unique_ptr<char[]>(new char[blockSize * blocksPerSlab]) );
+        slabUsedCt = 0;
+      }
+      return &slabs.back()[blockSize * slabUsedCt++];
+    }
+
+    void release(void* p) {
+      std::lock_guard<std::mutex> lock(mtx);
+      liveCt--;
+      freeList.push_back(p);
+    }
+
+    size_t getLiveCount() {
+      std::lock_guard<std::mutex> lock(mtx);
+      return liveCt;
+    }
+
+    void getStats(int64_t& tallocCt, int64_t& tpeakLiveCt) {
+      std::lock_guard<std::mutex> lock(mtx);
+      tallocCt = allocCt;
+      tpeakLiveCt = peakLiveCt;
+    }
+
+    size_t getBytesReserved() {
+      std::lock_guard<std::mutex> lock(mtx);
+      return slabs.size() * blockSize * blocksPerSlab + freeList.capacity() * sizeof(void*);
+    }
+  };
+
+
+  // a bump allocator for short-lived objects (e.g. the objects we make while parsing an nbt record) -- the memory is
+  // reused wholesale when everything that was allocated from it has been freed
+  // note: this is not thread-safe, use threadArena() (see ArenaAllocated)
+  class BumpArena {
+  private:
+    static const size_t kBlockSize = 64 * 1024;
+    std::vector< std::unique_ptr<char[]> > blocks;
+    size_t blockIndex;
+    size_t blockUsed;
+    size_t liveCt;
+    size_t bytesUsed;
+
+    static std::atomic<int64_t>& totalAllocCount() {
+      static std::atomic<int64_t> ct(0);
+      return ct;
+    }
+    static std::atomic<int64_t>& maxHighWater() {
+      static std::atomic<int64_t> hw(0);
+      return hw;
+    }
+    
+  public:
+    BumpArena() {
+      blockIndex = 0;
+      blockUsed = 0;
+      liveCt = 0;
+      bytesUsed = 0;
+    }
+
+    static BumpArena& threadArena() {
+      static thread_local BumpArena arena;
+      return arena;
+    }
+
+    // big objects are not worth it
+    static bool useArena(size_t size) {
+      return size <= (kBlockSize / 4);
+    }
+    
+    void* alloc(size_t size) {
+      if ( ! useArena(size) ) {
+        return ::operator new(size);
+      }
+      const size_t align = alignof(std::max_align_t);
+      size = (size + align - 1) & ~(align - 1);
+      if ( blockIndex >= blocks.size() || (blockUsed + size) > kBlockSize ) {
+        if ( blockIndex < blocks.size() ) {
+          blockIndex++;
+        }
+        if ( blockIndex >= blocks.size() ) {
+          blocks.push_back( std::unique_ptr<char[]>(new char[kBlockSize]) );
+        }
+        blockUsed = 0;
+      }
+      void* p = &blocks[blockIndex][blockUsed];
+      blockUsed += size;
+      bytesUsed += size;
+      liveCt++;
+      totalAllocCount()++;
+      int64_t hw = maxHighWater();
+      while ( (int64_t)bytesUsed > hw && ! maxHighWater().compare_exchange_weak(hw, (int64_t)bytesUsed) ) {
+        // retry
+      }
+      return p;
+    }
+
+    void release(void* p, size_t size) {
+      if ( ! useArena(size) ) {
+        ::operator delete(p);
+        return;
+      }
+      // everything is freed -- start over
+      if ( --liveCt == 0 ) {
+        blockIndex = 0;
+        blockUsed = 0;
+        bytesUsed = 0;
+      }
+    }
+
+    // totals for all threads
+    static void getStats(int64_t& allocCt, int64_t& highWater) {
+      allocCt = totalAllocCount();
+      highWater = maxHighWater();
+    }
+  };
+
+  // objects of classes derived from this come from the BumpArena of the current thread
+  // note: the objects must be freed on the thread that made them
+  class ArenaAllocated {
+  public:
+    static void* operator new(size_t size) {
+      return BumpArena::threadArena().alloc(size);
+    }
+    static void operator delete(void* p, size_t size) {
+      BumpArena::threadArena().release(p, size);
+    }
+  };
+  
+
   enum LogType : int32_t {
     // todobig - be more clever about this
     kLogInfo1 = 0x0001,
@@ -83,6 +379,11 @@ namespace mcpe_viz {
   const int32_t kLogQuiet = ( kLogWarning | kLogError | kLogFatalError );
 
   
+  class Logger;
+
+  // note: log output captured on a worker thread is stored as (logger, text) runs so that it can be replayed in order
+  typedef std::vector< std::pair<Logger*, std::string> > LogCaptureList;
+  
   // todolib - separate .cc/.h for each class... sigh
   class Logger {
   public:
@@ -116,6 +417,41 @@ namespace mcpe_viz {
     void setStderr(FILE *fp) {
       fpStderr = fp;
     }
+
+    // when a capture list is set for the current thread, messages are collected instead of written
+    static LogCaptureList*& captureList() {
+      static thread_local LogCaptureList* capture = nullptr;
+      return capture;
+    }
+
+    static void setCapture(LogCaptureList* capture) {
+      captureList() = capture;
+    }
+
+    static void replayCapture(const LogCaptureList& capture) {
+      for ( const auto& it : capture ) {
+        it.first->write(it.second);
+      }
+    }
+
+    int32_t write(const std::string& s) {
+      if ( fpStdout == nullptr ) {
+        return -1;
+      }
+      fwrite(s.data(), 1, s.size(), fpStdout);
+      if ( doFlushFlag ) {
+        fflush(fpStdout);
+      }
+      return 0;
+    }
+
+    const char* getLevelPrefix(int32_t levelMask) {
+      if (levelMask & kLogFatalError)   { return "** FATAL ERROR: "; }
+      else if (levelMask & kLogError)   { return "ERROR: "; }
+      else if (levelMask & kLogWarning) { return "WARNING: "; }
+      else if (levelMask & kLogInfo)    { return ""; } // "INFO: "
+      return ""; // "UNKNOWN: "
+    }
     
     // from: http://stackoverflow.com/questions/12573968/how-to-use-gccs-printf-format-attribute-with-c11-variadic-templates
     // make gcc check calls to this function like it checks printf et al
@@ -137,11 +473,33 @@ namespace mcpe_viz {
         return -1;
       }
       
-      if (levelMask & kLogFatalError)   { fprintf(fp,"** FATAL ERROR: "); }
-      else if (levelMask & kLogError)   { fprintf(fp,"ERROR: "); }
-      else if (levelMask & kLogWarning) { fprintf(fp,"WARNING: "); }
-      else if (levelMask & kLogInfo)    { } // fprintf(fp,"INFO: "); }
-      else                              { } // fprintf(fp,"UNKNOWN: "); }
+      LogCaptureList* capture = captureList();
+      if ( capture != nullptr && !(levelMask & kLogFatalError) ) {
+        std::string s(getLevelPrefix(levelMask));
+        char buf[1024];
+        va_list argptr;
+        va_start(argptr,fmt);
+        int32_t len = vsnprintf(buf, sizeof(buf), fmt, argptr);
+        va_end(argptr);
+        if ( len >= (int32_t)sizeof(buf) ) {
+          // message is too large for the stack buffer
+          std::vector<char> lbuf(len + 1);
+          va_start(argptr,fmt);
+          vsnprintf(lbuf.data(), lbuf.size(), fmt, argptr);
+          va_end(argptr);
+          s += lbuf.data();
+        } else if ( len > 0 ) {
+          s += buf;
+        }
+        if ( capture->size() > 0 && capture->back().first == this ) {
+          capture->back().second += s;
+        } else {
+          capture->push_back(std::make_pair(this, s));
+        }
+        return 0;
+      }
+      
+      fputs(getLevelPrefix(levelMask), fp);
       
       va_list argptr;
       va_start(argptr,fmt);
@@ -430,28 +788,409 @@ namespace mcpe_viz {
 
 
 
+  // a set of tiles (tile y, tile x)
+  typedef std::set< std::pair<int32_t, int32_t> > TileSet;
+
+
+  // writes the rows of an image straight to tile files (named fnBase.(tile y).(tile x).png)
+  // note: we keep one row of tiles open at a time
+  class PngTileWriter {
+  public:
+    std::string fnBase;
+    std::string dirOutput;
+    int32_t srcW, srcH;
+    int32_t tileWidth, tileHeight;
+    int32_t bpp;
+    bool rgbaFlag;
+    // if this is set, we only write these tiles (and any tiles that do not exist yet)
+    const TileSet* dirtyTiles;
+    int32_t writeCt, skipCt, errorCt;
+
+  private:
+    int32_t numPngW;
+    PngWriter* pngOut;
+    uint8_t** buf;
+    std::vector<bool> writeFlag;
+    int32_t sy;
+    int32_t tileCounterY;
+    bool initPngFlag;
+    bool openFlag;
+
+    void startTileRow() {
+      char tmpstring[1025];
+      for (int32_t i=0; i < numPngW; i++) {
+        snprintf(tmpstring, 1024, "%s/%s.%d.%d.png", dirOutput.c_str(), fnBase.c_str(), tileCounterY, i);
+        std::string fname = tmpstring;
+
+        // we leave unchanged tiles alone
+        writeFlag[i] = ( dirtyTiles == nullptr ||
+                         dirtyTiles->find( std::make_pair(tileCounterY, i) ) != dirtyTiles->end() ||
+                         ! file_exists(fname) );
+        if ( ! writeFlag[i] ) {
+          skipCt++;
+          continue;
+        }
+        // note: init logs the error
+        if ( pngOut[i].init(fname, "MCPE Viz Image Tile", tileWidth, tileHeight, tileHeight, rgbaFlag, true) != 0 ) {
+          writeFlag[i] = false;
+          errorCt++;
+          continue;
+        }
+        writeCt++;
+
+        // clear buffer
+        memset(&buf[i][0], 0, tileWidth * tileHeight * bpp);
+              
+        // setup row_pointers
+        for (int32_t ty=0; ty < tileHeight; ty++) {
+          pngOut[i].row_pointers[ty] = &buf[i][ty*tileWidth * bpp];
+        }
+      }
+      tileCounterY++;
+      initPngFlag = true;
+    }
+
+    void finishTileRow() {
+      for (int32_t i=0; i < numPngW; i++) {
+        if ( writeFlag[i] ) {
+          png_write_image(pngOut[i].png, pngOut[i].row_pointers);
+          pngOut[i].close();
+        }
+      }
+      initPngFlag = false;
+    }
+    
+  public:
+    PngTileWriter() {
+      srcW = srcH = 0;
+      tileWidth = tileHeight = 0;
+      bpp = 3;
+      rgbaFlag = false;
+      dirtyTiles = nullptr;
+      writeCt = skipCt = errorCt = 0;
+      numPngW = 0;
+      pngOut = nullptr;
+      buf = nullptr;
+      sy = 0;
+      tileCounterY = 0;
+      initPngFlag = false;
+      openFlag = false;
+    }
+
+    ~PngTileWriter() {
+      close();
+    }
+
+    int32_t init(const std::string& tfnBase, const std::string& dirOut, int32_t w, int32_t h, int32_t tileW, int32_t tileH,
+                 bool trgbaFlag, const TileSet* tdirtyTiles) {
+      fnBase = tfnBase;
+      dirOutput = dirOut;
+      srcW = w;
+      srcH = h;
+      tileWidth = tileW;
+      tileHeight = tileH;
+      rgbaFlag = trgbaFlag;
+      bpp = rgbaFlag ? 4 : 3;
+      dirtyTiles = tdirtyTiles;
+      writeCt = skipCt = errorCt = 0;
+      
+      numPngW = (int)ceil((double)srcW / (double)tileWidth);
+      pngOut = new PngWriter[numPngW];
+      writeFlag.assign(numPngW, true);
+      buf = new uint8_t*[numPngW];
+      for (int32_t i=0; i < numPngW; i++) {
+        buf[i] = new uint8_t[tileWidth * tileHeight * bpp];
+      }
+      sy = 0;
+      tileCounterY = 0;
+      initPngFlag = false;
+      openFlag = true;
+      return 0;
+    }
+
+    int32_t writeRow(const uint8_t* row) {
+      if ( ! initPngFlag ) {
+        startTileRow();
+      }
+
+      int32_t tileOffsetY = sy % tileHeight;
+      for (int32_t i=0; i < numPngW; i++) {
+        if ( ! writeFlag[i] ) {
+          continue;
+        }
+        int32_t sx = i * tileWidth;
+        int32_t w = std::min(tileWidth, srcW - sx);
+        memcpy(&buf[i][(tileOffsetY * tileWidth) * bpp], &row[sx * bpp], w * bpp);
+      }
+      sy++;
+
+      // write tile png files when they are ready
+      if ( (sy % tileHeight) == 0 ) {
+        finishTileRow();
+      }
+      return 0;
+    }
+
+    int32_t writeRows(uint8_t** rows, int32_t nrows) {
+      for (int32_t i=0; i < nrows; i++) {
+        writeRow(rows[i]);
+      }
+      return 0;
+    }
+    
+    int32_t close() {
+      if ( ! openFlag ) {
+        return 0;
+      }
+      
+      // close final tiles
+      if ( initPngFlag ) {
+        finishTileRow();
+      }
+      
+      delete [] pngOut;
+      pngOut = nullptr;
+      for (int32_t i=0; i < numPngW; i++) {
+        delete [] buf[i];
+      }
+      delete [] buf;
+      buf = nullptr;
+      openFlag = false;
+      return 0;
+    }
+  };
+
+
+  // number of zoom levels we need so that the most zoomed-out level fits in a single tile
+  inline int32_t getTileLevelCount(int32_t w, int32_t h, int32_t tileW, int32_t tileH) {
+    int32_t levelCt = 1;
+    while ( w > tileW || h > tileH ) {
+      w = (w + 1) / 2;
+      h = (h + 1) / 2;
+      levelCt++;
+    }
+    return levelCt;
+  }
+
+
+  // writes the rows of an image to a tile pyramid (named dirOut/(zoom level)/fnBase.(tile y).(tile x).png)
+  // zoom level (levelCt-1) is full resolution, each level below it is half the size of the one above it
+  // note: we make the lower levels by taking the top-left pixel of each 2x2 block instead of averaging --
+  //   the web app identifies blocks/biomes/heights from the pixel colors, so we must not invent new colors
+  class PngTilePyramid {
+  public:
+    int32_t levelCt;
+    int32_t writeCt, skipCt, errorCt;
+
+  private:
+    // index 0 is full resolution
+    std::vector< std::unique_ptr<PngTileWriter> > levels;
+    std::vector<TileSet> levelDirtyTiles;
+    std::vector<int32_t> levelW;
+    std::vector<int32_t> levelRowCt;
+    std::vector< std::vector<uint8_t> > levelRow;
+    int32_t bpp;
+    bool openFlag;
+
+  public:
+    PngTilePyramid() {
+      levelCt = 0;
+      writeCt = skipCt = errorCt = 0;
+      bpp = 3;
+      openFlag = false;
+    }
+
+    ~PngTilePyramid() {
+      close();
+    }
+
+    int32_t init(const std::string& fnBase, const std::string& dirOut, int32_t w, int32_t h, int32_t tileW, int32_t tileH,
+                 bool rgbaFlag, const TileSet* dirtyTiles) {
+      char tmpstring[1025];
+
+      bpp = rgbaFlag ? 4 : 3;
+      writeCt = skipCt = errorCt = 0;
+      levelCt = getTileLevelCount(w, h, tileW, tileH);
+
+      levels.clear();
+      levelDirtyTiles.assign(levelCt, TileSet());
+      levelW.assign(levelCt, 0);
+      levelRowCt.assign(levelCt, 0);
+      levelRow.assign(levelCt, std::vector<uint8_t>());
+
+      for (int32_t i=0; i < levelCt; i++) {
+        // a tile at this level covers a 2x2 block of tiles from the level above
+        const TileSet* levelDirty = nullptr;
+        if ( dirtyTiles != nullptr ) {
+          for ( const auto& it : *dirtyTiles ) {
+            levelDirtyTiles[i].insert( std::make_pair(it.first >> i, it.second >> i) );
+          }
+          levelDirty = &levelDirtyTiles[i];
+        }
+
+        snprintf(tmpstring, 1024, "%s/%d", dirOut.c_str(), levelCt - 1 - i);
+        std::string dirLevel = tmpstring;
+        if ( local_mkdir(dirLevel) != 0 && errno != EEXIST ) {
+          slogger.msg(kLogInfo1,"ERROR: Failed to create tile directory (%s) error=%s (%d)\n", dirLevel.c_str(), strerror(errno), errno);
+          return -1;
+        }
+
+        levels.push_back( std::unique_ptr<PngTileWriter>(new PngTileWriter()) );
+        if ( levels[i]->init(fnBase, dirLevel, w, h, tileW, tileH, rgbaFlag, levelDirty) != 0 ) {
+          return -1;
+        }
+        levelW[i] = w;
+        levelRow[i].resize(w * bpp);
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+      }
+      openFlag = true;
+      return 0;
+    }
+
+    int32_t writeRow(const uint8_t* row) {
+      const uint8_t* src = row;
+      for (int32_t i=0; i < levelCt; i++) {
+        levels[i]->writeRow(src);
+
+        // only the even rows make it to the next level
+        if ( (i+1) >= levelCt || (levelRowCt[i]++ % 2) != 0 ) {
+          break;
+        }
+        uint8_t* dest = &levelRow[i+1][0];
+        for (int32_t x=0; x < levelW[i+1]; x++) {
+          memcpy(&dest[x * bpp], &src[x * 2 * bpp], bpp);
+        }
+        src = dest;
+      }
+      return 0;
+    }
+
+    int32_t writeRows(uint8_t** rows, int32_t nrows) {
+      for (int32_t i=0; i < nrows; i++) {
+        writeRow(rows[i]);
+      }
+      return 0;
+    }
+
+    int32_t close() {
+      if ( ! openFlag ) {
+        return 0;
+      }
+      for ( auto& it : levels ) {
+        it->close();
+        writeCt += it->writeCt;
+        skipCt += it->skipCt;
+        errorCt += it->errorCt;
+      }
+      levels.clear();
+      openFlag = false;
+      return 0;
+    }
+  };
+
+
+  // writes an image row by row to a png file, straight to tiles (--direct-tiles), or both
+  class PngImageWriter {
+  public:
+    PngWriter png;
+    PngTilePyramid tiles;
+    std::string fnImage;
+    bool pngFlag;
+    bool tilesFlag;
+
+    PngImageWriter() {
+      pngFlag = false;
+      tilesFlag = false;
+    }
+
+    // an empty dirTiles means no tiles
+    int32_t init(const std::string& fn, const std::string& imageDescription, int32_t w, int32_t h, bool rgbaFlag,
+                 bool writePngFlag, const std::string& dirTiles, int32_t tileW, int32_t tileH, const TileSet* dirtyTiles) {
+      fnImage = fn;
+      pngFlag = writePngFlag;
+      tilesFlag = ( dirTiles.size() > 0 );
+      if ( pngFlag ) {
+        if ( png.init(fn, imageDescription, w, h, h, rgbaFlag, false) != 0 ) {
+          return -1;
+        }
+      }
+      if ( tilesFlag ) {
+        if ( tiles.init(mybasename(fn), dirTiles, w, h, tileW, tileH, rgbaFlag, dirtyTiles) != 0 ) {
+          return -1;
+        }
+      }
+      return 0;
+    }
+
+    int32_t writeRow(uint8_t* row) {
+      if ( pngFlag ) {
+        png_write_row(png.png, row);
+      }
+      if ( tilesFlag ) {
+        tiles.writeRow(row);
+      }
+      return 0;
+    }
+    
+    int32_t writeRows(uint8_t** rows, int32_t nrows) {
+      if ( pngFlag ) {
+        png_write_rows(png.png, rows, nrows);
+      }
+      if ( tilesFlag ) {
+        tiles.writeRows(rows, nrows);
+      }
+      return 0;
+    }
+
+    int32_t close() {
+      if ( pngFlag ) {
+        png.close();
+      }
+      if ( tilesFlag ) {
+        tiles.close();
+        if ( tiles.errorCt > 0 ) {
+          slogger.msg(kLogInfo1,"ERROR: Failed to create %d tiles for %s\n", tiles.errorCt, mybasename(fnImage).c_str());
+          return -1;
+        }
+      }
+      return 0;
+    }
+  };
+  
+  
+  // cut an existing image into tiles
   class PngTiler {
   public:
     std::string filename;
     int32_t tileWidth;
     int32_t tileHeight;
     std::string dirOutput;
+    // if this is set, we only write these tiles (and any tiles that do not exist yet)
+    const TileSet* dirtyTiles;
+    int32_t writeCt, skipCt;
         
     PngTiler(const std::string& fn, int32_t tileW, int32_t tileH, const std::string& dirOut) {
       filename = fn;
       tileWidth = tileW;
       tileHeight = tileH;
       dirOutput = dirOut;
+      dirtyTiles = nullptr;
+      writeCt = skipCt = 0;
+    }
+
+    void setDirtyTiles(const TileSet* tiles) {
+      dirtyTiles = tiles;
     }
 
     int32_t doTile() {
       // todobig - store tile filenames?
 
-      char tmpstring[256];
-
       // open source file
       PngReader pngSrc;
-      pngSrc.init(filename);
+      if ( pngSrc.init(filename) != 0 ) {
+        return -1;
+      }
       pngSrc.read_info();
 
       int32_t srcW = pngSrc.getWidth();
@@ -463,86 +1202,29 @@ namespace mcpe_viz {
         bpp = 4;
         rgbaFlag = true;
       }
-      int32_t numPngW = (int)ceil((double)srcW / (double)tileWidth);
 
       uint8_t *sbuf = new uint8_t[ srcW * bpp ];
 
-      
-      PngWriter *pngOut = new PngWriter[numPngW];
-      uint8_t **buf;
-      buf = new uint8_t*[numPngW];
-      for (int32_t i=0; i < numPngW; i++) {
-        buf[i] = new uint8_t[tileWidth * tileHeight * bpp];
+      PngTilePyramid tileWriter;
+      if ( tileWriter.init(mybasename(filename), dirOutput, srcW, srcH, tileWidth, tileHeight, rgbaFlag, dirtyTiles) != 0 ) {
+        pngSrc.close();
+        delete [] sbuf;
+        return -1;
       }
-        
-      bool initPngFlag = false;
-      int32_t tileCounterY=0;
-
+      
       for (int32_t sy=0; sy < srcH; sy++) {
-
-        // initialize png helpers
-        if ( ! initPngFlag ) {
-          initPngFlag = true;
-          for (int32_t i=0; i < numPngW; i++) {
-            sprintf(tmpstring,"%s/%s.%d.%d.png", dirOutput.c_str(), mybasename(filename).c_str(),
-                    tileCounterY, i);
-            std::string fname = tmpstring;
-            pngOut[i].init(fname, "MCPE Viz Image Tile", tileWidth, tileHeight, tileHeight, rgbaFlag, true);
-
-            // clear buffer
-            memset(&buf[i][0], 0, tileWidth * tileHeight * bpp);
-              
-            // setup row_pointers
-            for (int32_t ty=0; ty < tileHeight; ty++) {
-              pngOut[i].row_pointers[ty] = &buf[i][ty*tileWidth * bpp];
-            }
-          }
-          tileCounterY++;
-        }
-
         png_read_row(pngSrc.png, sbuf, NULL);
-
-        int32_t tileOffsetY = sy % tileHeight;
-          
-        // todobig - step in tileWidth and memcpy as we go - need to check the last one for out of bounds
-        for (int32_t sx=0; sx < srcW; sx++) {
-          int32_t tileCounterX = sx / tileWidth;
-          int32_t tileOffsetX = sx % tileWidth;
-          memcpy(&buf[tileCounterX][((tileOffsetY * tileWidth) + tileOffsetX) * bpp], &sbuf[sx*bpp], bpp);
-        }
-          
-        // write tile png files when they are ready
-        if ( ((sy+1) % tileHeight) == 0 ) {
-          // write pngs
-          for (int32_t i=0; i < numPngW; i++) {
-            png_write_image(pngOut[i].png, pngOut[i].row_pointers);
-            pngOut[i].close();
-          }
-          initPngFlag = false;
-        }
+        tileWriter.writeRow(sbuf);
       }
-
-      // close final tiles
-      if ( initPngFlag ) {
-        // write pngs
-        for (int32_t i=0; i < numPngW; i++) {
-          png_write_image(pngOut[i].png, pngOut[i].row_pointers);
-          pngOut[i].close();
-        }
-      }
-
-      delete [] pngOut;
-
-      for (int32_t i=0; i < numPngW; i++) {
-        delete [] buf[i];
-      }
-      delete [] buf;
+      tileWriter.close();
+      writeCt = tileWriter.writeCt;
+      skipCt = tileWriter.skipCt;
 
       pngSrc.close();
 
       delete [] sbuf;
       
-      return 0;
+      return ( tileWriter.errorCt > 0 ) ? -1 : 0;
     }
       
   };
@@ -649,36 +1331,591 @@ namespace mcpe_viz {
 
 
   
-  // todobig - template this for diff types?
-  typedef std::pair<int32_t, int32_t> HistogramItem;
-  typedef std::map<int32_t, int32_t> HistogramMap;
+  // geojson features are spooled to a temp file as they are made (instead of being held in memory), so memory use
+  // does not depend on how many features there are
+  // note: a feature is one json object with no trailing comma; features are dropped until open() is called
+  class GeoJsonSink {
+  private:
+    std::mutex mtx;
+    FILE* fp;
+    int64_t count;
+    std::string buf;
+    // the spool file lives next to the output (tmpfile() does not work for non-admin users on windows)
+    // note: transform flips between fnSpoolBase and fnSpoolBase.1; an empty fnSpool means we fell back to tmpfile()
+    std::string fnSpoolBase;
+    std::string fnSpool;
+
+    // todo - param?
+    static const size_t kBufferSize = 1024 * 1024;
+
+    FILE* openSpool(const std::string& fn, std::string& fnOpened) {
+      FILE* tfp = nullptr;
+      fnOpened = "";
+      if ( fn.size() > 0 ) {
+        tfp = fopen(fn.c_str(), "w+b");
+        if ( tfp ) {
+          fnOpened = fn;
+        }
+      }
+      if ( ! tfp ) {
+        tfp = tmpfile();
+      }
+      if ( tfp ) {
+        setvbuf(tfp, nullptr, _IOFBF, kBufferSize);
+      }
+      return tfp;
+    }
+
+    void closeSpool() {
+      if ( fp ) {
+        fclose(fp);
+        fp = nullptr;
+      }
+      if ( fnSpool.size() > 0 ) {
+        remove(fnSpool.c_str());
+        fnSpool = "";
+      }
+    }
+
+    // note: features are length-prefixed because they can contain newlines (e.g. sign text)
+    static bool put(FILE* tfp, const char* s, uint32_t len) {
+      return ( fwrite(&len, sizeof(len), 1, tfp) == 1 ) && ( len == 0 || fwrite(s, len, 1, tfp) == 1 );
+    }
+    bool get(FILE* tfp, std::string& s) {
+      uint32_t len;
+      if ( fread(&len, sizeof(len), 1, tfp) != 1 ) {
+        return false;
+      }
+      s.resize(len);
+      return ( len == 0 ) || ( fread(&s[0], len, 1, tfp) == 1 );
+    }
+    
+  public:
+    GeoJsonSink() {
+      fp = nullptr;
+      count = 0;
+    }
+
+    ~GeoJsonSink() {
+      close();
+    }
+
+    // fn is the spool file (e.g. out.geojson.spool) -- if we can't create it we use tmpfile()
+    int32_t open(const std::string& fn) {
+      std::lock_guard<std::mutex> lock(mtx);
+      closeSpool();
+      count = 0;
+      fnSpoolBase = fn;
+      fp = openSpool(fnSpoolBase, fnSpool);
+      return fp ? 0 : -1;
+    }
+
+    // note: this removes the spool file
+    void close() {
+      std::lock_guard<std::mutex> lock(mtx);
+      closeSpool();
+      count = 0;
+    }
+
+    bool isTempFile() {
+      std::lock_guard<std::mutex> lock(mtx);
+      return fp && ( fnSpool.size() == 0 );
+    }
+
+    void add(const std::string& json) {
+      std::lock_guard<std::mutex> lock(mtx);
+      if ( fp && put(fp, json.data(), json.size()) ) {
+        count++;
+      }
+    }
+
+    // add the features from a per-record (or per-thread) list, and clear it
+    void add(std::vector<std::string>& list) {
+      if ( list.size() == 0 ) {
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mtx);
+      for ( const auto& it : list ) {
+        if ( fp && put(fp, it.data(), it.size()) ) {
+          count++;
+        }
+      }
+      list.clear();
+    }
+
+    int64_t size() {
+      std::lock_guard<std::mutex> lock(mtx);
+      return count;
+    }
+
+    // call func(const std::string&) for each feature in the order they were added
+    template <class Func>
+    int32_t forEach(Func func) {
+      std::lock_guard<std::mutex> lock(mtx);
+      if ( ! fp ) {
+        return 0;
+      }
+      fflush(fp);
+      rewind(fp);
+      for (int64_t i=0; i < count; i++) {
+        if ( ! get(fp, buf) ) {
+          fseek(fp, 0, SEEK_END);
+          return -1;
+        }
+        func(buf);
+      }
+      fseek(fp, 0, SEEK_END);
+      return 0;
+    }
+
+    // rewrite each feature with func(std::string&) -- returns the number of features that func changed
+    template <class Func>
+    int64_t transform(Func func) {
+      std::lock_guard<std::mutex> lock(mtx);
+      if ( ! fp ) {
+        return 0;
+      }
+      std::string fnNew;
+      FILE* fpNew = openSpool(( fnSpool == fnSpoolBase ) ? fnSpoolBase + ".1" : fnSpoolBase, fnNew);
+      if ( ! fpNew ) {
+        return 0;
+      }
+      fflush(fp);
+      rewind(fp);
+      int64_t changeCt = 0, newCount = 0;
+      for (int64_t i=0; i < count && get(fp, buf); i++) {
+        if ( func(buf) ) {
+          changeCt++;
+        }
+        if ( put(fpNew, buf.data(), buf.size()) ) {
+          newCount++;
+        }
+      }
+      closeSpool();
+      fp = fpNew;
+      fnSpool = fnNew;
+      count = newCount;
+      return changeCt;
+    }
+  };
+
+
+  // compact columnar version of the geojson features (see decodeFeatureBinary in mcpe_viz.js)
+  // note: all values are little-endian; sections are padded to 4 bytes so that the web app can use typed array views
+  //   header: "MVZF", version, featureCount, pointCount, propCount, stringCount, stringBytes (uint32 each)
+  //   uint32 pointStart[featureCount+1], float32 coords[pointCount*2]
+  //   uint32 propStart[featureCount+1], uint32 propKey[propCount], uint32 propValue[propCount]
+  //   uint32 typeId[featureCount] (string index of "Name" value), uint8 geomType[featureCount], int8 dimId[featureCount]
+  //   uint32 stringStart[stringCount+1], char stringData[stringBytes]
+  // the string table holds raw json text (keys with quotes) so that each distinct value is only parsed once
+  class GeoJsonColumns {
+  public:
+    static const uint32_t kVersion = 1;
+    static const uint32_t kNoType = 0xffffffff;
+    static const uint8_t kGeomPoint = 0;
+    static const uint8_t kGeomMultiPoint = 1;
+
+    std::vector<uint32_t> pointStart;
+    std::vector<float> coords;
+    std::vector<uint32_t> propStart;
+    std::vector<uint32_t> propKey;
+    std::vector<uint32_t> propValue;
+    std::vector<uint32_t> typeId;
+    std::vector<uint8_t> geomType;
+    std::vector<int8_t> dimId;
+    std::vector<std::string> stringList;
+    std::unordered_map<std::string, uint32_t> stringMap;
+    int32_t errorCt;
+
+    GeoJsonColumns() {
+      clear();
+    }
+
+    void clear() {
+      pointStart.assign(1, 0);
+      coords.clear();
+      propStart.assign(1, 0);
+      propKey.clear();
+      propValue.clear();
+      typeId.clear();
+      geomType.clear();
+      dimId.clear();
+      stringList.clear();
+      stringMap.clear();
+      errorCt = 0;
+    }
+
+    size_t size() const {
+      return typeId.size();
+    }
+
+    uint32_t intern(const char* p, size_t len) {
+      std::string s(p, len);
+      const auto& it = stringMap.find(s);
+      if ( it != stringMap.end() ) {
+        return it->second;
+      }
+      uint32_t idx = (uint32_t)stringList.size();
+      stringList.push_back(s);
+      stringMap[s] = idx;
+      return idx;
+    }
+
+    // we log the first few features that we can't parse
+    static const int32_t kMaxErrorLog = 10;
+
+    void logError(const std::string& json) {
+      if ( ++errorCt <= kMaxErrorLog ) {
+        slogger.msg(kLogInfo1,"ERROR: Could not parse geojson item for the binary feature file: %.200s\n", json.c_str());
+      }
+    }
+
+    // add one feature (as made by makeGeojsonHeader et al) -- returns false (and skips it) if we can't parse it
+    // note: this depends on the exact layout of the writers -- the caller must not use the columns if errorCt > 0
+    bool add(const std::string& json) {
+      const char* s = json.c_str();
+      const char* pgeom = strstr(s, "\"geometry\":{\"type\":\"MultiPoint\"");
+      uint8_t gtype = pgeom ? kGeomMultiPoint : kGeomPoint;
+      const char* p = strstr(s, "\"coordinates\":[");
+      const char* pprops = p ? strstr(p, "\"properties\":{") : nullptr;
+      if ( ! pprops ) {
+        logError(json);
+        return false;
+      }
+      p += strlen("\"coordinates\":[");
+
+      // coordinates -- [x,y] for Point; [[x,y],...] for MultiPoint
+      size_t coordCt = coords.size();
+      for (;;) {
+        while ( *p == '[' || *p == ',' || *p == ' ' ) { p++; }
+        if ( *p == ']' || *p == 0 ) {
+          break;
+        }
+        char* pend;
+        double x = strtod(p, &pend);
+        if ( pend == p || *pend != ',' ) {
+          break;
+        }
+        p = pend + 1;
+        double y = strtod(p, &pend);
+        if ( pend == p ) {
+          break;
+        }
+        p = pend;
+        coords.push_back((float)x);
+        coords.push_back((float)y);
+        if ( gtype == kGeomPoint ) {
+          break;
+        }
+        while ( *p == ']' && p[1] == ',' ) { p++; }
+      }
+      if ( coords.size() == coordCt ) {
+        logError(json);
+        return false;
+      }
+
+      // properties -- top level members only; the values are kept as raw json text
+      size_t propCt = propKey.size();
+      uint32_t tid = kNoType;
+      int32_t did = -1;
+      p = pprops + strlen("\"properties\":{");
+      for (;;) {
+        while ( *p == ' ' || *p == ',' || *p == '\n' ) { p++; }
+        if ( *p != '"' ) {
+          break;
+        }
+        const char* pkey = p;
+        p = skipValue(p);
+        size_t keyLen = p - pkey;
+        while ( *p == ' ' ) { p++; }
+        if ( *p != ':' ) {
+          break;
+        }
+        p++;
+        while ( *p == ' ' ) { p++; }
+        const char* pval = p;
+        p = skipValue(p);
+        if ( p == pval ) {
+          break;
+        }
+        uint32_t kidx = intern(pkey, keyLen);
+        uint32_t vidx = intern(pval, p - pval);
+        propKey.push_back(kidx);
+        propValue.push_back(vidx);
+        if ( stringList[kidx] == "\"Name\"" ) {
+          tid = vidx;
+        }
+        else if ( stringList[kidx] == "\"Dimension\"" ) {
+          did = atoi(pval + (*pval == '"' ? 1 : 0));
+        }
+      }
+      if ( *p != '}' ) {
+        // roll back the partial feature
+        coords.resize(coordCt);
+        propKey.resize(propCt);
+        propValue.resize(propCt);
+        logError(json);
+        return false;
+      }
+
+      pointStart.push_back((uint32_t)(coords.size() / 2));
+      propStart.push_back((uint32_t)propKey.size());
+      typeId.push_back(tid);
+      geomType.push_back(gtype);
+      dimId.push_back((int8_t)did);
+      return true;
+    }
+
+    int32_t write(const std::string& fn) const {
+      std::vector<const std::string*> strings;
+      strings.reserve(stringList.size());
+      for ( const auto& it : stringList ) {
+        strings.push_back(&it);
+      }
+      return writeFile(fn, pointStart, coords, propStart, propKey, propValue, typeId, geomType, dimId, strings);
+    }
+
+    // write just some of the features (e.g. one tile) -- the strings are renumbered so the file only has the ones it uses
+    int32_t writeSubset(const std::string& fn, const std::vector<uint32_t>& featureList) const {
+      std::vector<uint32_t> spointStart(1, 0), spropStart(1, 0);
+      std::vector<float> scoords;
+      std::vector<uint32_t> spropKey, spropValue, stypeId;
+      std::vector<uint8_t> sgeomType;
+      std::vector<int8_t> sdimId;
+      std::vector<const std::string*> strings;
+      std::unordered_map<uint32_t, uint32_t> stringRemap;
+      auto remap = [&](uint32_t idx) -> uint32_t {
+        const auto& it = stringRemap.find(idx);
+        if ( it != stringRemap.end() ) {
+          return it->second;
+        }
+        uint32_t sidx = (uint32_t)strings.size();
+        strings.push_back(&stringList[idx]);
+        stringRemap[idx] = sidx;
+        return sidx;
+      };
+      for ( uint32_t i : featureList ) {
+        scoords.insert(scoords.end(), coords.begin() + pointStart[i] * 2, coords.begin() + pointStart[i+1] * 2);
+        for (uint32_t j = propStart[i]; j < propStart[i+1]; j++) {
+          spropKey.push_back(remap(propKey[j]));
+          spropValue.push_back(remap(propValue[j]));
+        }
+        spointStart.push_back((uint32_t)(scoords.size() / 2));
+        spropStart.push_back((uint32_t)spropKey.size());
+        stypeId.push_back(( typeId[i] != kNoType ) ? remap(typeId[i]) : kNoType);
+        sgeomType.push_back(geomType[i]);
+        sdimId.push_back(dimId[i]);
+      }
+      return writeFile(fn, spointStart, scoords, spropStart, spropKey, spropValue, stypeId, sgeomType, sdimId, strings);
+    }
+
+  private:
+    // note: we use a temp file + rename so that the web app never sees a partial file
+    static int32_t writeFile(const std::string& fn, const std::vector<uint32_t>& pointStart, const std::vector<float>& coords,
+                             const std::vector<uint32_t>& propStart, const std::vector<uint32_t>& propKey,
+                             const std::vector<uint32_t>& propValue, const std::vector<uint32_t>& typeId,
+                             const std::vector<uint8_t>& geomType, const std::vector<int8_t>& dimId,
+                             const std::vector<const std::string*>& stringList) {
+      std::string fnTemp = fn + ".tmp";
+      FILE* fp = fopen(fnTemp.c_str(), "wb");
+      if ( ! fp ) {
+        return -1;
+      }
+      std::vector<uint32_t> stringStart(1, 0);
+      for ( const auto& it : stringList ) {
+        stringStart.push_back(stringStart.back() + (uint32_t)it->size());
+      }
+      std::vector<uint32_t> header = {
+        kVersion, (uint32_t)typeId.size(), (uint32_t)(coords.size() / 2), (uint32_t)propKey.size(),
+        (uint32_t)stringList.size(), stringStart.back()
+      };
+      bool okFlag = true;
+      put(fp, "MVZF", 4, okFlag);
+      putVector(fp, header, okFlag);
+      putVector(fp, pointStart, okFlag);
+      putVector(fp, coords, okFlag);
+      putVector(fp, propStart, okFlag);
+      putVector(fp, propKey, okFlag);
+      putVector(fp, propValue, okFlag);
+      putVector(fp, typeId, okFlag);
+      putVector(fp, geomType, okFlag);
+      putVector(fp, dimId, okFlag);
+      putVector(fp, stringStart, okFlag);
+      for ( const auto& it : stringList ) {
+        put(fp, it->data(), it->size(), okFlag);
+      }
+      if ( fclose(fp) != 0 ) {
+        okFlag = false;
+      }
+      if ( ! okFlag || replaceFile(fnTemp, fn) != 0 ) {
+        remove(fnTemp.c_str());
+        return -1;
+      }
+      return 0;
+    }
+
+    // skip a json value (string, number, literal, object, array) -- returns pointer to the char after it
+    static const char* skipValue(const char* p) {
+      int32_t depth = 0;
+      bool inString = false;
+      for ( ; *p; p++ ) {
+        if ( inString ) {
+          if ( *p == '\\' && p[1] ) {
+            p++;
+          }
+          else if ( *p == '"' ) {
+            inString = false;
+            if ( depth == 0 ) {
+              return p + 1;
+            }
+          }
+          continue;
+        }
+        switch ( *p ) {
+        case '"':
+          inString = true;
+          break;
+        case '{':
+        case '[':
+          depth++;
+          break;
+        case '}':
+        case ']':
+          if ( depth == 0 ) {
+            return p;
+          }
+          if ( --depth == 0 ) {
+            return p + 1;
+          }
+          break;
+        case ',':
+          if ( depth == 0 ) {
+            return p;
+          }
+          break;
+        case ' ':
+          if ( depth == 0 ) {
+            return p;
+          }
+          break;
+        }
+      }
+      return p;
+    }
+
+    static void put(FILE* fp, const void* p, size_t len, bool& okFlag) {
+      if ( okFlag && len > 0 && fwrite(p, len, 1, fp) != 1 ) {
+        okFlag = false;
+      }
+    }
+
+    // note: we put the bytes in little-endian order ourselves so that the file is the same on any host
+    template <class T>
+    static void putVector(FILE* fp, const std::vector<T>& v, bool& okFlag) {
+      static_assert(sizeof(T) == 1 || sizeof(T) == 4, "putVector only handles 8 and 32 bit values");
+      static const char pad[4] = { 0, 0, 0, 0 };
+      size_t len = v.size() * sizeof(T);
+      if ( sizeof(T) == 1 ) {
+        put(fp, v.data(), len, okFlag);
+      } else {
+        std::vector<uint8_t> buf(len);
+        for (size_t i=0; i < v.size(); i++) {
+          uint32_t x;
+          memcpy(&x, &v[i], 4);
+          buf[i*4]   = (uint8_t)(x);
+          buf[i*4+1] = (uint8_t)(x >> 8);
+          buf[i*4+2] = (uint8_t)(x >> 16);
+          buf[i*4+3] = (uint8_t)(x >> 24);
+        }
+        put(fp, buf.data(), len, okFlag);
+      }
+      if ( len % 4 ) {
+        put(fp, pad, 4 - (len % 4), okFlag);
+      }
+    }
+  };
+
+
+  // counts for block id's (0..511) and biome id's (0..255)
+  // note: this is a flat array because it is updated for every block in the world; keys outside 0..511 are
+  //   counted together in an overflow bucket, which shows up in getItems() et al as key kOverflowKey
+  typedef std::pair<int32_t, int64_t> HistogramItem;
   typedef std::vector< HistogramItem > HistogramVector;
   class Histogram {
   public:
-    HistogramMap map;
+    static const int32_t kSize = 512;
+    static const int32_t kOverflowKey = kSize;
+    int64_t counts[kSize];
+    int64_t overflowCt;
+
+    Histogram() {
+      clear();
+    }
+
+    void clear() {
+      memset(counts, 0, sizeof(counts));
+      overflowCt = 0;
+    }
     
-    bool has_key(int32_t k) {
-      return map.find(k) != map.end();
+    bool has_key(int32_t k) const {
+      return ( (uint32_t)k < (uint32_t)kSize ) && ( counts[k] > 0 );
     }
     
     void add(int32_t k) {
-      if ( has_key(k) ) {
-        map[k]++;
+      if ( (uint32_t)k < (uint32_t)kSize ) {
+        counts[k]++;
       } else {
-        map[k] = 1;
+        overflowCt++;
       }
     }
 
-    int32_t getTotal() {
-      int32_t total=0;
-      for (auto& it : map) {
-        total += it.second;
+    // note: this also takes kOverflowKey, so that getItems() can be merged back in (e.g. from the chunk cache)
+    void add(int32_t k, int64_t count) {
+      if ( (uint32_t)k < (uint32_t)kSize ) {
+        counts[k] += count;
+      } else {
+        overflowCt += count;
+      }
+    }
+
+    // merge counts from another histogram (e.g. one filled by a worker thread)
+    void merge(const Histogram& h) {
+      for (int32_t i=0; i < kSize; i++) {
+        counts[i] += h.counts[i];
+      }
+      overflowCt += h.overflowCt;
+    }
+
+    void merge(const HistogramVector& v) {
+      for ( const auto& it : v ) {
+        add(it.first, it.second);
+      }
+    }
+
+    // the non-zero counts in key order
+    HistogramVector getItems() const {
+      HistogramVector vector;
+      for (int32_t i=0; i < kSize; i++) {
+        if ( counts[i] > 0 ) {
+          vector.push_back(HistogramItem(i, counts[i]));
+        }
+      }
+      if ( overflowCt > 0 ) {
+        vector.push_back(HistogramItem((int32_t)kOverflowKey, overflowCt));
+      }
+      return vector;
+    }
+    
+    int64_t getTotal() const {
+      int64_t total=overflowCt;
+      for (int32_t i=0; i < kSize; i++) {
+        total += counts[i];
       }
       return total;
     }
     
-    HistogramVector sort(int32_t order) {
-      HistogramVector vector(map.begin(), map.end());
+    HistogramVector sort(int32_t order) const {
+      HistogramVector vector = getItems();
       
       if ( order <= 0 ) {
         std::sort(vector.begin(), vector.end(), compare_less_());